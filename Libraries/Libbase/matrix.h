@@ -121,6 +121,9 @@ public:
  * \note Range-checking and other validation functions are only operative in
  * debug mode.
  *
+ * \note As with vectors, memory is obtained through the per-thread memory
+ * pool.
+ *
  *
  * \todo Extract common implementation of copy assignment operators
  *
@@ -131,6 +134,7 @@ template <class T>
 class matrix {
    friend class masked_matrix<T> ;
 private:
+   typedef pool_allocator<T> Allocator;
    size_type<libbase::matrix> m_size;
    T **m_data;
 protected:
@@ -177,6 +181,35 @@ public:
       }
    // @}
 
+#if __cplusplus >= 201103L
+   /*! \name Move semantics */
+   /*! \brief Move constructor
+    * Takes over the elements of the given matrix, leaving it empty.
+    */
+   matrix(matrix<T>&& x) :
+         m_size(x.m_size), m_data(x.m_data)
+      {
+      x.m_size = size_type<libbase::matrix> (0, 0);
+      x.m_data = NULL;
+      }
+   /*! \brief Move assignment operator
+    * Takes over the elements of the given matrix, leaving it empty.
+    */
+   matrix<T>& operator=(matrix<T>&& x)
+      {
+      if (this != &x)
+         {
+         free();
+         m_size = x.m_size;
+         m_data = x.m_data;
+         x.m_size = size_type<libbase::matrix> (0, 0);
+         x.m_data = NULL;
+         }
+      return *this;
+      }
+   // @}
+#endif
+
    /*! \name Resizing operations */
    void init(const int m, const int n);
    /*! \copydoc init()
@@ -374,9 +407,14 @@ inline void matrix<T>::free()
    {
    if (m_size > 0)
       {
+      Allocator allocator;
       for (int i = 0; i < m_size.rows(); i++)
-         delete[] m_data[i];
-      delete[] m_data;
+         {
+         for (int j = 0; j < m_size.cols(); j++)
+            allocator.destroy(&m_data[i][j]);
+         allocator.deallocate(m_data[i], m_size.cols());
+         }
+      pool_allocator<T*> ().deallocate(m_data, m_size.rows());
       }
    }
 
@@ -395,10 +433,16 @@ inline void matrix<T>::alloc(const int x, const int y)
       {
       assertalways(x>0 && y>0);
       m_size = size_type<libbase::matrix> (x, y);
-      typedef T* Tp;
-      m_data = new Tp[x];
+      Allocator allocator;
+      m_data = pool_allocator<T*> ().allocate(x);
+      // allocate rows and call default constructor
+      const T element = T();
       for (int i = 0; i < x; i++)
-         m_data[i] = new T[y];
+         {
+         m_data[i] = allocator.allocate(y);
+         for (int j = 0; j < y; j++)
+            allocator.construct(&m_data[i][j], element);
+         }
       }
    }
 
@@ -106,6 +106,10 @@ public:
    matrix3(const int x = 0, const int y = 0, const int z = 0); // constructor (does not initialise elements)
    matrix3(const matrix3<T>& x); // copy constructor
    ~matrix3();
+#if __cplusplus >= 201103L
+   matrix3(matrix3<T>&& x); // move constructor (leaves x empty)
+   matrix3<T>& operator=(matrix3<T>&& x); // move assignment (leaves x empty)
+#endif
 
    // resizing operations
    void init(const int x, const int y, const int z);
@@ -319,6 +323,33 @@ inline matrix3<T>& matrix3<T>::operator=(const matrix3<T>& x)
    return *this;
    }
 
+#if __cplusplus >= 201103L
+template <class T>
+inline matrix3<T>::matrix3(matrix3<T>&& x) :
+      m_xsize(x.m_xsize), m_ysize(x.m_ysize), m_zsize(x.m_zsize), m_data(
+            x.m_data)
+   {
+   x.m_xsize = x.m_ysize = x.m_zsize = 0;
+   x.m_data = NULL;
+   }
+
+template <class T>
+inline matrix3<T>& matrix3<T>::operator=(matrix3<T>&& x)
+   {
+   if (this != &x)
+      {
+      free();
+      m_xsize = x.m_xsize;
+      m_ysize = x.m_ysize;
+      m_zsize = x.m_zsize;
+      m_data = x.m_data;
+      x.m_xsize = x.m_ysize = x.m_zsize = 0;
+      x.m_data = NULL;
+      }
+   return *this;
+   }
+#endif
+
 template <class T>
 inline matrix3<T>& matrix3<T>::operator=(const T x)
    {
@@ -0,0 +1,168 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memory_pool.h"
+
+namespace libbase {
+
+namespace {
+
+//! Pool in use by this thread, while within a scope
+memory_pool* thread_current = NULL;
+//! Pool belonging to this thread, created on first use
+memory_pool* thread_owned = NULL;
+
+#ifdef USE_OMP
+#  pragma omp threadprivate(thread_current, thread_owned)
+#endif
+
+}
+
+// internal functions
+
+int memory_pool::size_class(size_t bytes)
+   {
+   const size_t total = bytes + sizeof(header);
+   for (int c = 0; c < classes; c++)
+      if (total <= class_size(c))
+         return c;
+   return -1;
+   }
+
+memory_pool*& memory_pool::current()
+   {
+   return thread_current;
+   }
+
+void memory_pool::trim(size_t keep)
+   {
+   // release blocks from the largest class first
+   for (int c = classes - 1; c >= 0 && count.held > keep; c--)
+      while (freelist[c] && count.held > keep)
+         {
+         void* block = freelist[c];
+         freelist[c] = *static_cast<void**> (block);
+         count.held -= class_size(c);
+         ::operator delete(block);
+         }
+   }
+
+// constructors / destructors
+
+memory_pool::memory_pool(size_t limit) :
+   limit(limit), depth(0)
+   {
+   for (int c = 0; c < classes; c++)
+      freelist[c] = NULL;
+   count.allocations = 0;
+   count.reused = 0;
+   count.held = 0;
+   }
+
+memory_pool::~memory_pool()
+   {
+   assert(depth == 0);
+   release();
+   }
+
+// block allocation
+
+/*!
+ * \brief Allocate a block of at least the given size
+ *
+ * The block is taken from the pool in use by the current thread if one of
+ * the right size class is held, and from the system otherwise.
+ */
+void* memory_pool::allocate(size_t bytes)
+   {
+   const int c = size_class(bytes);
+   memory_pool* pool = current();
+   void* block = NULL;
+   if (pool)
+      {
+      pool->count.allocations++;
+      if (c >= 0 && pool->freelist[c])
+         {
+         block = pool->freelist[c];
+         pool->freelist[c] = *static_cast<void**> (block);
+         pool->count.held -= class_size(c);
+         pool->count.reused++;
+         }
+      }
+   if (!block)
+      block = ::operator new(c >= 0 ? class_size(c) : bytes + sizeof(header));
+   static_cast<header*> (block)->size_class = c;
+   return static_cast<char*> (block) + sizeof(header);
+   }
+
+/*!
+ * \brief Release a block obtained from allocate()
+ *
+ * The block is kept by the pool in use by the current thread, if any;
+ * otherwise it is returned to the system.
+ */
+void memory_pool::deallocate(void* p)
+   {
+   if (!p)
+      return;
+   void* block = static_cast<char*> (p) - sizeof(header);
+   const int c = static_cast<header*> (block)->size_class;
+   memory_pool* pool = current();
+   if (pool && c >= 0)
+      {
+      *static_cast<void**> (block) = pool->freelist[c];
+      pool->freelist[c] = block;
+      pool->count.held += class_size(c);
+      }
+   else
+      ::operator delete(block);
+   }
+
+// pool management
+
+memory_pool& memory_pool::thread_pool()
+   {
+   if (!thread_owned)
+      thread_owned = new memory_pool;
+   return *thread_owned;
+   }
+
+// scope
+
+memory_pool::scope::scope() :
+   pool(thread_pool())
+   {
+   start = pool.count;
+   pool.depth++;
+   current() = &pool;
+   }
+
+memory_pool::scope::~scope()
+   {
+   assert(pool.depth > 0);
+   if (--pool.depth == 0)
+      {
+      current() = NULL;
+      pool.trim(pool.limit);
+      }
+   }
+
+} // end namespace
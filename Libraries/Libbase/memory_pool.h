@@ -0,0 +1,194 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __memory_pool_h
+#define __memory_pool_h
+
+#include "config.h"
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace libbase {
+
+/*!
+ * \brief   Per-thread Memory Pool.
+ * \author  Johann Briffa
+ *
+ * Keeps memory blocks released by containers, sorted by size class, so that
+ * they can be handed out again without going through the system allocator.
+ * This is meant for code that repeatedly creates and destroys the same set
+ * of temporaries, such as a simulation sample.
+ *
+ * A pool is used by a thread only within the lifetime of a memory_pool::scope
+ * object; each thread has its own pool, so no locking is needed. Outside a
+ * scope, blocks come from and are returned to the system allocator.
+ *
+ * Every block is obtained from the system allocator with a short header that
+ * records its size class. Blocks can therefore outlive the scope in which
+ * they were allocated, and can be freed on any thread: they are simply
+ * kept by the pool in use at that point, or returned to the system. Blocks
+ * larger than the largest size class are never kept.
+ *
+ * When the outermost scope on a thread ends, the pool keeps its blocks for
+ * the next scope, up to a limit on the total memory held.
+ */
+
+class memory_pool {
+public:
+   /*! \name Statistics */
+   struct stats {
+      long allocations; //!< Number of blocks requested
+      long reused; //!< Number of blocks handed out from the pool
+      size_t held; //!< Memory held by the pool, in bytes
+   };
+   // @}
+private:
+   /*! \name Internal representation */
+   //! Smallest size class, as a power of two
+   static const int min_class = 4;
+   //! Number of size classes kept
+   static const int classes = 17;
+   //! Block header, recording the size class (or -1 if not kept)
+   union header {
+      int size_class;
+      double align_d;
+      void* align_p;
+      char pad[16];
+   };
+   void* freelist[classes]; //!< Released blocks, linked through first word
+   size_t limit; //!< Maximum memory to hold between scopes
+   int depth; //!< Nesting depth of scopes currently using this pool
+   stats count; //!< Usage statistics
+   // @}
+private:
+   /*! \name Internal functions */
+   //! Size class for the given number of bytes, or -1 if not kept
+   static int size_class(size_t bytes);
+   //! Size of blocks in the given class, in bytes
+   static size_t class_size(int c)
+      {
+      return size_t(1) << (c + min_class);
+      }
+   //! Pool in use by the current thread (NULL if none)
+   static memory_pool*& current();
+   //! Release held blocks until the total is within the given limit
+   void trim(size_t keep);
+   // @}
+   /*! \name Law of the Big Three */
+   //! Copy constructor (disabled)
+   memory_pool(const memory_pool&);
+   //! Copy assignment (disabled)
+   memory_pool& operator=(const memory_pool&);
+   // @}
+public:
+   /*! \name Constructors / Destructors */
+   explicit memory_pool(size_t limit = size_t(64) << 20);
+   ~memory_pool();
+   // @}
+
+   /*! \name Block allocation */
+   //! Allocate a block of at least the given size, from the current pool
+   static void* allocate(size_t bytes);
+   //! Release a block to the current pool, or to the system
+   static void deallocate(void* p);
+   // @}
+
+   /*! \name Pool management */
+   //! Release all held blocks to the system
+   void release()
+      {
+      trim(0);
+      }
+   //! Statistics for this pool
+   const stats& get_stats() const
+      {
+      return count;
+      }
+   //! Pool belonging to the current thread
+   static memory_pool& thread_pool();
+   // @}
+
+   /*!
+    * \brief   Scope for using the thread's memory pool.
+    *
+    * Blocks allocated on this thread during the lifetime of this object are
+    * taken from the thread's pool, and blocks released are kept there.
+    * Scopes may be nested.
+    */
+   class scope {
+   private:
+      memory_pool& pool;
+      stats start;
+   private:
+      scope(const scope&);
+      scope& operator=(const scope&);
+   public:
+      scope();
+      ~scope();
+      //! Blocks requested since the start of this scope
+      long allocations() const
+         {
+         return pool.count.allocations - start.allocations;
+         }
+      //! Blocks reused from the pool since the start of this scope
+      long reused() const
+         {
+         return pool.count.reused - start.reused;
+         }
+   };
+};
+
+/*!
+ * \brief   Allocator using the per-thread memory pool.
+ * \author  Johann Briffa
+ *
+ * Memory is taken from the current thread's memory pool when within a
+ * memory_pool::scope, or otherwise from the system.
+ */
+
+template <class T>
+class pool_allocator : public std::allocator<T> {
+private:
+   typedef std::allocator<T> Base;
+public:
+   typedef typename Base::pointer pointer;
+   typedef typename Base::size_type size_type;
+
+   template <class U>
+   struct rebind {
+      typedef pool_allocator<U> other;
+   };
+
+   pointer allocate(size_type n, std::allocator<void>::const_pointer hint = 0)
+      {
+      return static_cast<pointer> (memory_pool::allocate(n * sizeof(T)));
+      }
+
+   void deallocate(pointer p, size_type n)
+      {
+      memory_pool::deallocate(p);
+      }
+};
+
+} // end namespace
+
+#endif
@@ -25,6 +25,7 @@
 #include "config.h"
 #include "size.h"
 #include "aligned_allocator.h"
+#include "memory_pool.h"
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -58,6 +59,8 @@ template <class T>
 class indirect_vector;
 template <class T>
 class masked_vector;
+template <class T, class L, class R, class Op>
+class vector_expr;
 
 /*!
  * \brief   Size specialization for vector.
@@ -109,6 +112,257 @@ public:
       }
 };
 
+/*!
+ * \brief   Scalar operand in vector expressions.
+ * \author  Johann Briffa
+ *
+ * Represents a scalar value as an operand of an element-wise vector
+ * expression; this is the same for all elements.
+ */
+
+template <class T>
+class vector_scalar {
+private:
+   const T value;
+public:
+   explicit vector_scalar(const T& value) :
+         value(value)
+      {
+      }
+   const T& operator()(const int i) const
+      {
+      return value;
+      }
+};
+
+/*!
+ * \brief   Operand storage for vector expressions.
+ * \author  Johann Briffa
+ *
+ * Vectors are held by reference, while scalars and sub-expressions (which are
+ * small temporary objects) are held by value.
+ */
+
+template <class X>
+struct vector_operand {
+   typedef const X type;
+};
+
+template <class T>
+struct vector_operand<vector<T> > {
+   typedef const vector<T>& type;
+};
+
+/*! \name Element-wise operations for vector expressions */
+struct vector_add {
+   template <class T>
+   static T apply(const T& a, const T& b)
+      {
+      return a + b;
+      }
+};
+
+struct vector_sub {
+   template <class T>
+   static T apply(const T& a, const T& b)
+      {
+      return a - b;
+      }
+};
+
+struct vector_mul {
+   template <class T>
+   static T apply(const T& a, const T& b)
+      {
+      return a * b;
+      }
+};
+
+struct vector_div {
+   template <class T>
+   static T apply(const T& a, const T& b)
+      {
+      return a / b;
+      }
+};
+// @}
+
+/*!
+ * \brief   Element-wise Vector Expression.
+ * \author  Johann Briffa
+ *
+ * This is the result of the binary arithmetic operators on vectors. Rather
+ * than computing the result immediately, the expression keeps its operands,
+ * and is only evaluated when it is assigned to a vector (or used to construct
+ * one). This is done in a single loop over all elements, so that compound
+ * expressions like (a + b) * c require no temporary vectors.
+ *
+ * \note Since vector operands are held by reference, an expression should be
+ * evaluated within the statement that creates it.
+ *
+ * \note Element-wise evaluation also means that it is safe for the vector
+ * being assigned to appear in the expression, as in: a = b - a.
+ */
+
+template <class T, class L, class R, class Op>
+class vector_expr {
+private:
+   typename vector_operand<L>::type lhs;
+   typename vector_operand<R>::type rhs;
+public:
+   /*! \name Constructors */
+   vector_expr(const L& lhs, const R& rhs) :
+         lhs(lhs), rhs(rhs)
+      {
+      }
+   // @}
+
+   /*! \name Element access */
+   //! Evaluate a single element of the expression
+   T operator()(const int i) const
+      {
+      return Op::template apply<T>(lhs(i), rhs(i));
+      }
+   //! Number of elements
+   int size() const
+      {
+      return lhs.size();
+      }
+   // @}
+
+   /*! \name Statistical operations
+    * These evaluate each element of the expression once, without storing the
+    * result.
+    */
+   T min() const
+      {
+      assertalways(size() > 0);
+      T result = (*this)(0);
+      for (int i = 1; i < size(); i++)
+         {
+         const T x = (*this)(i);
+         if (x < result)
+            result = x;
+         }
+      return result;
+      }
+   T max() const
+      {
+      assertalways(size() > 0);
+      T result = (*this)(0);
+      for (int i = 1; i < size(); i++)
+         {
+         const T x = (*this)(i);
+         if (x > result)
+            result = x;
+         }
+      return result;
+      }
+   T sum() const
+      {
+      assertalways(size() > 0);
+      T result = 0;
+      for (int i = 0; i < size(); i++)
+         result += (*this)(i);
+      return result;
+      }
+   T sumsq() const
+      {
+      assertalways(size() > 0);
+      T result = 0;
+      for (int i = 0; i < size(); i++)
+         {
+         const T x = (*this)(i);
+         result += x * x;
+         }
+      return result;
+      }
+   // @}
+
+   /*! \name Arithmetic operations - compound expressions */
+   vector_expr<T, vector_expr, vector<T>, vector_add> operator+(
+         const vector<T>& x) const
+      {
+      assert(x.size() == size());
+      return vector_expr<T, vector_expr, vector<T>, vector_add> (*this, x);
+      }
+   vector_expr<T, vector_expr, vector<T>, vector_sub> operator-(
+         const vector<T>& x) const
+      {
+      assert(x.size() == size());
+      return vector_expr<T, vector_expr, vector<T>, vector_sub> (*this, x);
+      }
+   vector_expr<T, vector_expr, vector<T>, vector_mul> operator*(
+         const vector<T>& x) const
+      {
+      assert(x.size() == size());
+      return vector_expr<T, vector_expr, vector<T>, vector_mul> (*this, x);
+      }
+   vector_expr<T, vector_expr, vector<T>, vector_div> operator/(
+         const vector<T>& x) const
+      {
+      assert(x.size() == size());
+      return vector_expr<T, vector_expr, vector<T>, vector_div> (*this, x);
+      }
+   template <class L2, class R2, class Op2>
+   vector_expr<T, vector_expr, vector_expr<T, L2, R2, Op2> , vector_add> operator+(
+         const vector_expr<T, L2, R2, Op2>& x) const
+      {
+      assert(x.size() == size());
+      return vector_expr<T, vector_expr, vector_expr<T, L2, R2, Op2> ,
+            vector_add> (*this, x);
+      }
+   template <class L2, class R2, class Op2>
+   vector_expr<T, vector_expr, vector_expr<T, L2, R2, Op2> , vector_sub> operator-(
+         const vector_expr<T, L2, R2, Op2>& x) const
+      {
+      assert(x.size() == size());
+      return vector_expr<T, vector_expr, vector_expr<T, L2, R2, Op2> ,
+            vector_sub> (*this, x);
+      }
+   template <class L2, class R2, class Op2>
+   vector_expr<T, vector_expr, vector_expr<T, L2, R2, Op2> , vector_mul> operator*(
+         const vector_expr<T, L2, R2, Op2>& x) const
+      {
+      assert(x.size() == size());
+      return vector_expr<T, vector_expr, vector_expr<T, L2, R2, Op2> ,
+            vector_mul> (*this, x);
+      }
+   template <class L2, class R2, class Op2>
+   vector_expr<T, vector_expr, vector_expr<T, L2, R2, Op2> , vector_div> operator/(
+         const vector_expr<T, L2, R2, Op2>& x) const
+      {
+      assert(x.size() == size());
+      return vector_expr<T, vector_expr, vector_expr<T, L2, R2, Op2> ,
+            vector_div> (*this, x);
+      }
+   vector_expr<T, vector_expr, vector_scalar<T> , vector_add> operator+(
+         const T x) const
+      {
+      return vector_expr<T, vector_expr, vector_scalar<T> , vector_add> (
+            *this, vector_scalar<T> (x));
+      }
+   vector_expr<T, vector_expr, vector_scalar<T> , vector_sub> operator-(
+         const T x) const
+      {
+      return vector_expr<T, vector_expr, vector_scalar<T> , vector_sub> (
+            *this, vector_scalar<T> (x));
+      }
+   vector_expr<T, vector_expr, vector_scalar<T> , vector_mul> operator*(
+         const T x) const
+      {
+      return vector_expr<T, vector_expr, vector_scalar<T> , vector_mul> (
+            *this, vector_scalar<T> (x));
+      }
+   vector_expr<T, vector_expr, vector_scalar<T> , vector_div> operator/(
+         const T x) const
+      {
+      return vector_expr<T, vector_expr, vector_scalar<T> , vector_div> (
+            *this, vector_scalar<T> (x));
+      }
+   // @}
+};
+
 /*!
  * \brief   Generic Vector.
  * \author  Johann Briffa
@@ -117,6 +371,9 @@ public:
  *
  * \note Multiplication and division perform array operations
  *
+ * \note Memory is obtained through the per-thread memory pool, so that
+ * temporaries created within a memory_pool::scope reuse earlier blocks.
+ *
  * \warning Unlike most other classes, this class uses stream I/O as
  * serialization for loading and saving; they therefore output
  * container size together with container elements.
@@ -135,7 +392,7 @@ class vector {
    friend class indirect_vector<T> ;
    friend class masked_vector<T> ;
 protected:
-   typedef std::allocator<T> Allocator;
+   typedef pool_allocator<T> Allocator;
    Allocator allocator;
    size_type<libbase::vector> m_size;
    T *m_data;
@@ -187,6 +444,21 @@ public:
    vector<T>& operator=(const vector<T>& x);
    // @}
 
+#if __cplusplus >= 201103L
+   /*! \name Move semantics */
+   /*! \brief Move constructor
+    * \note Takes over the elements of the given vector, leaving it empty;
+    * indirect vectors do not own their elements, so these are copied.
+    */
+   vector(vector<T>&& x);
+   /*! \brief Move assignment operator
+    * \note Takes over the elements of the given vector, leaving it empty;
+    * indirect vectors do not own their elements, so these are copied.
+    */
+   vector<T>& operator=(vector<T>&& x);
+   // @}
+#endif
+
    /*! \name Other Constructors */
    /*! \brief Default constructor
     * Allocates space as requested, but does not initialize elements.
@@ -201,6 +473,12 @@ public:
     */
    template <class A>
    explicit vector(const std::vector<A>& x);
+   /*! \brief Evaluation of element-wise expression
+    * \note The expression is evaluated in a single pass; its elements are
+    * converted to this vector's type if necessary.
+    */
+   template <class A, class L, class R, class Op>
+   vector(const vector_expr<A, L, R, Op>& x);
    // @}
 
    /*! \name Vector copy and value initialisation */
@@ -225,6 +503,12 @@ public:
     */
    template <class A>
    vector<T>& operator=(const A x);
+   /*! \brief Assignment from element-wise expression
+    * \note The expression is evaluated in a single pass, and may include this
+    * vector as an operand.
+    */
+   template <class A, class L, class R, class Op>
+   vector<T>& operator=(const vector_expr<A, L, R, Op>& x);
    /*! \brief Auto-converting copy assignment for indirect vectors
     * \note Naturally this requires a deep copy.
     */
@@ -353,17 +637,48 @@ public:
    vector<T>& operator-=(const T x);
    vector<T>& operator*=(const T x);
    vector<T>& operator/=(const T x);
+   template <class L, class R, class Op>
+   vector<T>& operator+=(const vector_expr<T, L, R, Op>& x);
+   template <class L, class R, class Op>
+   vector<T>& operator-=(const vector_expr<T, L, R, Op>& x);
+   template <class L, class R, class Op>
+   vector<T>& operator*=(const vector_expr<T, L, R, Op>& x);
+   template <class L, class R, class Op>
+   vector<T>& operator/=(const vector_expr<T, L, R, Op>& x);
    // @}
 
-   /*! \name Arithmetic operations - binary */
-   vector<T> operator+(const vector<T>& x) const;
-   vector<T> operator-(const vector<T>& x) const;
-   vector<T> operator*(const vector<T>& x) const;
-   vector<T> operator/(const vector<T>& x) const;
-   vector<T> operator+(const T x) const;
-   vector<T> operator-(const T x) const;
-   vector<T> operator*(const T x) const;
-   vector<T> operator/(const T x) const;
+   /*! \name Arithmetic operations - binary
+    * These return an element-wise expression, which is evaluated when
+    * assigned to a vector.
+    */
+   vector_expr<T, vector<T> , vector<T> , vector_add> operator+(
+         const vector<T>& x) const;
+   vector_expr<T, vector<T> , vector<T> , vector_sub> operator-(
+         const vector<T>& x) const;
+   vector_expr<T, vector<T> , vector<T> , vector_mul> operator*(
+         const vector<T>& x) const;
+   vector_expr<T, vector<T> , vector<T> , vector_div> operator/(
+         const vector<T>& x) const;
+   template <class L, class R, class Op>
+   vector_expr<T, vector<T> , vector_expr<T, L, R, Op> , vector_add> operator+(
+         const vector_expr<T, L, R, Op>& x) const;
+   template <class L, class R, class Op>
+   vector_expr<T, vector<T> , vector_expr<T, L, R, Op> , vector_sub> operator-(
+         const vector_expr<T, L, R, Op>& x) const;
+   template <class L, class R, class Op>
+   vector_expr<T, vector<T> , vector_expr<T, L, R, Op> , vector_mul> operator*(
+         const vector_expr<T, L, R, Op>& x) const;
+   template <class L, class R, class Op>
+   vector_expr<T, vector<T> , vector_expr<T, L, R, Op> , vector_div> operator/(
+         const vector_expr<T, L, R, Op>& x) const;
+   vector_expr<T, vector<T> , vector_scalar<T> , vector_add> operator+(
+         const T x) const;
+   vector_expr<T, vector<T> , vector_scalar<T> , vector_sub> operator-(
+         const T x) const;
+   vector_expr<T, vector<T> , vector_scalar<T> , vector_mul> operator*(
+         const T x) const;
+   vector_expr<T, vector<T> , vector_scalar<T> , vector_div> operator/(
+         const T x) const;
    // @}
 
    /*! \name Boolean operations - modifying */
@@ -581,6 +896,49 @@ inline vector<T>::vector(const vector<T>& x) :
    test_invariant();
    }
 
+#if __cplusplus >= 201103L
+template <class T>
+inline vector<T>::vector(vector<T>&& x) :
+   m_size(0), m_data(NULL)
+   {
+   test_invariant();
+   if (typeid(x) == typeid(vector<T>))
+      {
+      // take over the allocated memory (and its record, if any)
+      m_size = x.m_size;
+      m_data = x.m_data;
+      x.m_size = size_type<libbase::vector> (0);
+      x.m_data = NULL;
+      }
+   else
+      {
+      alloc(x.m_size.length());
+      copy(m_data, x.m_data, m_size.length());
+      }
+   test_invariant();
+   }
+#endif
+
+template <class T>
+template <class A, class L, class R, class Op>
+inline vector<T>::vector(const vector_expr<A, L, R, Op>& x) :
+   m_size(0), m_data(NULL)
+   {
+   test_invariant();
+   alloc(x.size());
+   // avoid down-cast warnings in Win32
+#ifdef _WIN32
+#  pragma warning( push )
+#  pragma warning( disable : 4244 4800 )
+#endif
+   for (int i = 0; i < m_size.length(); i++)
+      m_data[i] = x(i);
+#ifdef _WIN32
+#  pragma warning( pop )
+#endif
+   test_invariant();
+   }
+
 template <class T>
 template <class A>
 inline vector<T>::vector(const vector<A>& x) :
@@ -660,6 +1018,27 @@ inline vector<T>& vector<T>::operator=(const vector<T>& x)
    return *this;
    }
 
+#if __cplusplus >= 201103L
+template <class T>
+inline vector<T>& vector<T>::operator=(vector<T>&& x)
+   {
+   test_invariant();
+   // correctly handle self-assignment
+   if (this == &x)
+      return *this;
+   // indirect vectors can only be copied, whether as source or destination
+   if (typeid(x) != typeid(vector<T>) || typeid(*this) != typeid(vector<T>))
+      return *this = static_cast<const vector<T>&> (x);
+   free();
+   m_size = x.m_size;
+   m_data = x.m_data;
+   x.m_size = size_type<libbase::vector> (0);
+   x.m_data = NULL;
+   test_invariant();
+   return *this;
+   }
+#endif
+
 template <class T>
 template <class A>
 inline vector<T>& vector<T>::operator=(const vector<A>& x)
@@ -704,6 +1083,27 @@ inline vector<T>& vector<T>::operator=(const A x)
    return *this;
    }
 
+template <class T>
+template <class A, class L, class R, class Op>
+inline vector<T>& vector<T>::operator=(const vector_expr<A, L, R, Op>& x)
+   {
+   test_invariant();
+   // NOTE: if this vector is an operand, its size is already correct
+   init(x.size());
+   // avoid down-cast warnings in Win32
+#ifdef _WIN32
+#  pragma warning( push )
+#  pragma warning( disable : 4244 4800 )
+#endif
+   for (int i = 0; i < m_size.length(); i++)
+      m_data[i] = x(i);
+#ifdef _WIN32
+#  pragma warning( pop )
+#endif
+   test_invariant();
+   return *this;
+   }
+
 // Resizing operations
 
 template <class T>
@@ -989,86 +1389,170 @@ inline vector<T>& vector<T>::operator/=(const T x)
    return *this;
    }
 
-// arithmetic operations - binary
+template <class T>
+template <class L, class R, class Op>
+inline vector<T>& vector<T>::operator+=(const vector_expr<T, L, R, Op>& x)
+   {
+   test_invariant();
+   assert(x.size() == m_size.length());
+   for (int i = 0; i < m_size.length(); i++)
+      m_data[i] += x(i);
+   test_invariant();
+   return *this;
+   }
 
 template <class T>
-inline vector<T> vector<T>::operator+(const vector<T>& x) const
+template <class L, class R, class Op>
+inline vector<T>& vector<T>::operator-=(const vector_expr<T, L, R, Op>& x)
    {
    test_invariant();
-   vector<T> r = *this;
-   r += x;
+   assert(x.size() == m_size.length());
+   for (int i = 0; i < m_size.length(); i++)
+      m_data[i] -= x(i);
    test_invariant();
-   return r;
+   return *this;
    }
 
 template <class T>
-inline vector<T> vector<T>::operator-(const vector<T>& x) const
+template <class L, class R, class Op>
+inline vector<T>& vector<T>::operator*=(const vector_expr<T, L, R, Op>& x)
    {
    test_invariant();
-   vector<T> r = *this;
-   r -= x;
+   assert(x.size() == m_size.length());
+   for (int i = 0; i < m_size.length(); i++)
+      m_data[i] *= x(i);
    test_invariant();
-   return r;
+   return *this;
    }
 
 template <class T>
-inline vector<T> vector<T>::operator*(const vector<T>& x) const
+template <class L, class R, class Op>
+inline vector<T>& vector<T>::operator/=(const vector_expr<T, L, R, Op>& x)
    {
    test_invariant();
-   vector<T> r = *this;
-   r *= x;
+   assert(x.size() == m_size.length());
+   for (int i = 0; i < m_size.length(); i++)
+      m_data[i] /= x(i);
    test_invariant();
-   return r;
+   return *this;
    }
 
+// arithmetic operations - binary
+
 template <class T>
-inline vector<T> vector<T>::operator/(const vector<T>& x) const
+inline vector_expr<T, vector<T> , vector<T> , vector_add> vector<T>::operator+(
+      const vector<T>& x) const
    {
    test_invariant();
-   vector<T> r = *this;
-   r /= x;
+   assert(x.m_size.length() == m_size.length());
+   return vector_expr<T, vector<T> , vector<T> , vector_add> (*this, x);
+   }
+
+template <class T>
+inline vector_expr<T, vector<T> , vector<T> , vector_sub> vector<T>::operator-(
+      const vector<T>& x) const
+   {
    test_invariant();
-   return r;
+   assert(x.m_size.length() == m_size.length());
+   return vector_expr<T, vector<T> , vector<T> , vector_sub> (*this, x);
    }
 
 template <class T>
-inline vector<T> vector<T>::operator+(const T x) const
+inline vector_expr<T, vector<T> , vector<T> , vector_mul> vector<T>::operator*(
+      const vector<T>& x) const
    {
    test_invariant();
-   vector<T> r = *this;
-   r += x;
+   assert(x.m_size.length() == m_size.length());
+   return vector_expr<T, vector<T> , vector<T> , vector_mul> (*this, x);
+   }
+
+template <class T>
+inline vector_expr<T, vector<T> , vector<T> , vector_div> vector<T>::operator/(
+      const vector<T>& x) const
+   {
    test_invariant();
-   return r;
+   assert(x.m_size.length() == m_size.length());
+   return vector_expr<T, vector<T> , vector<T> , vector_div> (*this, x);
    }
 
 template <class T>
-inline vector<T> vector<T>::operator-(const T x) const
+template <class L, class R, class Op>
+inline vector_expr<T, vector<T> , vector_expr<T, L, R, Op> , vector_add> vector<T>::operator+(
+      const vector_expr<T, L, R, Op>& x) const
    {
    test_invariant();
-   vector<T> r = *this;
-   r -= x;
+   assert(x.size() == m_size.length());
+   return vector_expr<T, vector<T> , vector_expr<T, L, R, Op> , vector_add> (*this,
+         x);
+   }
+
+template <class T>
+template <class L, class R, class Op>
+inline vector_expr<T, vector<T> , vector_expr<T, L, R, Op> , vector_sub> vector<T>::operator-(
+      const vector_expr<T, L, R, Op>& x) const
+   {
    test_invariant();
-   return r;
+   assert(x.size() == m_size.length());
+   return vector_expr<T, vector<T> , vector_expr<T, L, R, Op> , vector_sub> (*this,
+         x);
    }
 
 template <class T>
-inline vector<T> vector<T>::operator*(const T x) const
+template <class L, class R, class Op>
+inline vector_expr<T, vector<T> , vector_expr<T, L, R, Op> , vector_mul> vector<T>::operator*(
+      const vector_expr<T, L, R, Op>& x) const
    {
    test_invariant();
-   vector<T> r = *this;
-   r *= x;
+   assert(x.size() == m_size.length());
+   return vector_expr<T, vector<T> , vector_expr<T, L, R, Op> , vector_mul> (*this,
+         x);
+   }
+
+template <class T>
+template <class L, class R, class Op>
+inline vector_expr<T, vector<T> , vector_expr<T, L, R, Op> , vector_div> vector<T>::operator/(
+      const vector_expr<T, L, R, Op>& x) const
+   {
    test_invariant();
-   return r;
+   assert(x.size() == m_size.length());
+   return vector_expr<T, vector<T> , vector_expr<T, L, R, Op> , vector_div> (*this,
+         x);
    }
 
 template <class T>
-inline vector<T> vector<T>::operator/(const T x) const
+inline vector_expr<T, vector<T> , vector_scalar<T> , vector_add> vector<T>::operator+(
+      const T x) const
    {
    test_invariant();
-   vector<T> r = *this;
-   r /= x;
+   return vector_expr<T, vector<T> , vector_scalar<T> , vector_add> (*this,
+         vector_scalar<T> (x));
+   }
+
+template <class T>
+inline vector_expr<T, vector<T> , vector_scalar<T> , vector_sub> vector<T>::operator-(
+      const T x) const
+   {
    test_invariant();
-   return r;
+   return vector_expr<T, vector<T> , vector_scalar<T> , vector_sub> (*this,
+         vector_scalar<T> (x));
+   }
+
+template <class T>
+inline vector_expr<T, vector<T> , vector_scalar<T> , vector_mul> vector<T>::operator*(
+      const T x) const
+   {
+   test_invariant();
+   return vector_expr<T, vector<T> , vector_scalar<T> , vector_mul> (*this,
+         vector_scalar<T> (x));
+   }
+
+template <class T>
+inline vector_expr<T, vector<T> , vector_scalar<T> , vector_div> vector<T>::operator/(
+      const T x) const
+   {
+   test_invariant();
+   return vector_expr<T, vector<T> , vector_scalar<T> , vector_div> (*this,
+         vector_scalar<T> (x));
    }
 
 // boolean operations - modifying
@@ -1393,6 +1877,34 @@ public:
       dynamic_cast<vector<T>&> (*this) = x;
       return *this;
       }
+
+   /*! \brief Assignment from element-wise expression
+    * \note This operation is only defined if the size is already correct.
+    */
+   template <class A, class L, class R, class Op>
+   indirect_vector<T>& operator=(const vector_expr<A, L, R, Op>& x)
+      {
+      assert(Base::m_size.length() == x.size());
+      Base::operator=(x);
+      return *this;
+      }
+
+#if __cplusplus >= 201103L
+   /*! \name Move semantics
+    * An indirect vector does not own its elements, so that moving is the same
+    * as copying: construction is a shallow copy, while assignment is a deep
+    * copy into the referenced elements.
+    */
+   indirect_vector(indirect_vector<T>&& x) :
+         indirect_vector(static_cast<const indirect_vector<T>&> (x))
+      {
+      }
+   indirect_vector<T>& operator=(indirect_vector<T>&& x)
+      {
+      return *this = static_cast<const indirect_vector<T>&> (x);
+      }
+   // @}
+#endif
 };
 
 // internal functions
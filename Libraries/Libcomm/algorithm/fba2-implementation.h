@@ -53,8 +53,115 @@ int fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::scale_z
 
 #endif
 
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+const double fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::log16_step = 1.0 / 256;
+
 // *** Internal functions - computer
 
+// gamma storage
+
+/*!
+ * \brief Table of values represented by each code in 16-bit log format
+ *
+ * Code zero represents a zero value; code 'c' > 0 represents the value
+ * \f$ e^{-(c-1) s} \f$ where \f$ s \f$ is the resolution in nats.
+ */
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+const double* fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::log16_table()
+   {
+   static std::vector<double> table;
+#ifdef USE_OMP
+#pragma omp critical(fba2_log16_table)
+#endif
+   if (table.empty())
+      {
+      std::vector<double> temp(1 << 16);
+      temp[0] = 0;
+      for (int c = 1; c < (1 << 16); c++)
+         temp[c] = exp(-(c - 1) * log16_step);
+      table.swap(temp);
+      }
+   return &table[0];
+   }
+
+/*!
+ * \brief Store gamma values for all symbols at the indicated state
+ * \param[in] ptable Gamma values, indexed by symbol 'd' and drift change
+ * \param[in] i Codeword index
+ * \param[in] x Drift at start of codeword
+ *
+ * In global storage mode, values below the given fraction of the largest
+ * value at this state are stored as zero. For compressed formats, values are
+ * stored relative to this largest value, which is kept at full precision;
+ * the alpha and beta metrics are always computed at full precision.
+ */
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::store_gamma(
+      const array1vr_t& ptable, int i, int x) const
+   {
+   if (!globalstore)
+      {
+      for (int d = 0; d < q; d++)
+         for (int deltax = mn_min; deltax <= mn_max; deltax++)
+            gamma.local[x][d][deltax] = ptable(d)(deltax - mn_min);
+      return;
+      }
+   // determine the largest value at this state, and the cut-off below it
+   real scale = 0;
+   for (int d = 0; d < q; d++)
+      for (int deltax = mn_min; deltax <= mn_max; deltax++)
+         if (ptable(d)(deltax - mn_min) > scale)
+            scale = ptable(d)(deltax - mn_min);
+   const real cutoff = scale * real(gamma_threshold);
+   if (gamma_format != Base::gamma_format_real)
+      gamma.scale[i][x] = scale;
+   for (int d = 0; d < q; d++)
+      for (int deltax = mn_min; deltax <= mn_max; deltax++)
+         {
+         real value = ptable(d)(deltax - mn_min);
+         if (value < cutoff)
+            value = 0;
+         // relative value, for compressed formats
+         const double ratio = (scale > real(0)) ? double(value / scale) : 0;
+         switch (gamma_format)
+            {
+            case Base::gamma_format_float:
+               gamma.global_float[i][x][d][deltax] = float(ratio);
+               break;
+            case Base::gamma_format_log16:
+               {
+               // codes beyond the representable range are stored as zero
+               const double level = (ratio > 0) ? -log(ratio) / log16_step
+                     : 65535;
+               gamma.global_log16[i][x][d][deltax] =
+                     (level < 65534) ? libbase::int16u(level + 1.5) : 0;
+               }
+               break;
+            default:
+               gamma.global[i][x][d][deltax] = value;
+               break;
+            }
+#ifndef NDEBUG
+         // keep track of storage statistics
+         gamma_stored++;
+         const real stored = gamma_storage_entry(d, i, x, deltax);
+         const real actual = ptable(d)(deltax - mn_min);
+         if (stored == real(0))
+            gamma_zeros++;
+         else if (actual > real(0))
+            {
+            const double error = fabs(double(stored / actual) - 1);
+            if (error > gamma_error)
+               gamma_error = error;
+            }
+#endif
+         }
+   }
+
+
 // common small tasks
 
 template <class receiver_t, class sig, class real, class real2,
@@ -96,19 +203,112 @@ real fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::get_th
    return 0;
    }
 
+/*! \brief Reset the list of surviving states for all indices
+ * All states are considered to be possibly non-zero, and no index is marked
+ * as pruned until its forward metric is computed.
+ */
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::reset_frontier()
+   {
+   if (!thresholding)
+      return;
+   frontier.resize(N + 1);
+   for (int i = 0; i <= N; i++)
+      {
+      frontier[i].x_min = mtau_min;
+      frontier[i].x_max = mtau_max;
+      frontier[i].pruned = false;
+      frontier[i].states.clear();
+      }
+   }
+
+/*! \brief Determine the surviving states at the given index
+ * Keeps the states with a non-zero forward metric at or above the inner
+ * threshold; the threshold is determined only over the range of states that
+ * could have been reached, so that neither this nor the recursions that
+ * follow scan the whole drift range.
+ *
+ * \note This needs to be called after the forward metric at index 'i' is
+ *       computed and normalized, and before it is used.
+ */
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::prune_alpha(const int i)
+   {
+   if (!thresholding)
+      return;
+   frontier_t& f = frontier[i];
+   const real threshold = get_threshold(alpha, i, f.x_min, f.x_max, th_inner,
+         tp_states);
+   f.pruned = (threshold > real(0));
+   f.states.clear();
+   for (int x = f.x_min; x <= f.x_max; x++)
+      {
+      const real this_alpha = alpha[i][x];
+      // ignore paths with zero metric or below the threshold
+      if (this_alpha == real(0) || this_alpha < threshold)
+         continue;
+      f.states.push_back(x);
+      }
+   }
+
 // decode functions - partial computations
 
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_alpha(
+      const int i, const int x1, const real prev_alpha)
+   {
+   // limits on deltax can be combined as (c.f. allocate() for details):
+   //   x2-x1 <= mn_max
+   //   x2-x1 >= mn_min
+   const int x2min = std::max(mtau_min, mn_min + x1);
+   const int x2max = std::min(mtau_max, mn_max + x1);
+   for (int x2 = x2min; x2 <= x2max; x2++)
+      {
+      // NOTE: we're repeating the loop on x2, so we need to increment this
+      real this_alpha_change = 0;
+      for (int d = 0; d < q; d++)
+         {
+         real temp = prev_alpha;
+         temp *= get_gamma(d, i - 1, x1, x2 - x1);
+         this_alpha_change += temp;
+         }
+      alpha[i][x2] += this_alpha_change;
+      }
+   }
+
 template <class receiver_t, class sig, class real, class real2,
       bool thresholding, bool lazy, bool globalstore>
 void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_alpha(
       const int i)
    {
-   // determine the strongest path at this point
-   const real threshold = get_threshold(alpha, i - 1, mtau_min, mtau_max,
-         th_inner, tp_states);
+   if (thresholding)
+      {
+      // follow only the paths that survived at the previous index
+      const std::vector<int>& states = frontier[i - 1].states;
+      for (size_t k = 0; k < states.size(); k++)
+         work_alpha(i, states[k], alpha[i - 1][states[k]]);
+      // determine the range of states that could be reached
+      frontier_t& f = frontier[i];
+      if (states.empty())
+         {
+         f.x_min = mtau_min;
+         f.x_max = mtau_min - 1;
+         }
+      else
+         {
+         f.x_min = std::max(mtau_min, mn_min + states.front());
+         f.x_max = std::min(mtau_max, mn_max + states.back());
+         }
 #if DEBUG>=3
-   int count = 0;
+      if (tp_states > 0 && int(states.size()) != tp_states)
+      std::cerr << "DEBUG (work_alpha): i=" << i << ", path count="
+      << states.size() << std::endl;
 #endif
+      return;
+      }
    for (int x1 = mtau_min; x1 <= mtau_max; x1++)
       {
       // cache previous alpha value in a register
@@ -116,35 +316,8 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_a
       // ignore paths with zero metric
       if (prev_alpha == real(0))
          continue;
-      // ignore paths below a certain threshold
-      if (thresholding && prev_alpha < threshold)
-         continue;
-#if DEBUG>=3
-      count++;
-#endif
-      // limits on deltax can be combined as (c.f. allocate() for details):
-      //   x2-x1 <= mn_max
-      //   x2-x1 >= mn_min
-      const int x2min = std::max(mtau_min, mn_min + x1);
-      const int x2max = std::min(mtau_max, mn_max + x1);
-      for (int x2 = x2min; x2 <= x2max; x2++)
-         {
-         // NOTE: we're repeating the loop on x2, so we need to increment this
-         real this_alpha_change = 0;
-         for (int d = 0; d < q; d++)
-            {
-            real temp = prev_alpha;
-            temp *= get_gamma(d, i - 1, x1, x2 - x1);
-            this_alpha_change += temp;
-            }
-         alpha[i][x2] += this_alpha_change;
-         }
+      work_alpha(i, x1, prev_alpha);
       }
-#if DEBUG>=3
-   if (tp_states > 0 && count != tp_states)
-   std::cerr << "DEBUG (work_alpha): i=" << i << ", path count=" << count
-   << std::endl;
-#endif
    }
 
 template <class receiver_t, class sig, class real, class real2,
@@ -152,12 +325,39 @@ template <class receiver_t, class sig, class real, class real2,
 void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_beta(
       const int i)
    {
-   // determine the strongest forward path at this point
-   const real threshold = get_threshold(alpha, i + 1, mtau_min, mtau_max,
-         th_inner, tp_states);
+   if (thresholding && frontier[i + 1].pruned)
+      {
+      // follow only the paths that survived the forward pass
+      // NOTE: this row is already zero, as beta is reset before each pass
+      const std::vector<int>& states = frontier[i + 1].states;
+      for (size_t k = 0; k < states.size(); k++)
+         {
+         const int x2 = states[k];
+         // cache next beta value in a register
+         const real next_beta = beta[i + 1][x2];
+         // ignore paths with zero metric
+         if (next_beta == real(0))
+            continue;
+         // limits on deltax can be combined as (c.f. allocate() for details):
+         //   x2-x1 <= mn_max
+         //   x2-x1 >= mn_min
+         const int x1min = std::max(mtau_min, x2 - mn_max);
+         const int x1max = std::min(mtau_max, x2 - mn_min);
+         for (int x1 = x1min; x1 <= x1max; x1++)
+            for (int d = 0; d < q; d++)
+               {
+               real temp = next_beta;
+               temp *= get_gamma(d, i, x1, x2 - x1);
+               beta[i][x1] += temp;
+               }
+         }
 #if DEBUG>=3
-   int count = 0;
+      if (tp_states > 0 && int(states.size()) != tp_states)
+      std::cerr << "DEBUG (work_beta): i=" << i << ", path count="
+      << states.size() << std::endl;
 #endif
+      return;
+      }
    for (int x1 = mtau_min; x1 <= mtau_max; x1++)
       {
       real this_beta = 0;
@@ -168,12 +368,6 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_b
       const int x2max = std::min(mtau_max, mn_max + x1);
       for (int x2 = x2min; x2 <= x2max; x2++)
          {
-         // ignore paths below a certain threshold
-         if (thresholding && alpha[i + 1][x2] < threshold)
-            continue;
-#if DEBUG>=3
-         count++;
-#endif
          // cache next beta value in a register
          const real next_beta = beta[i + 1][x2];
          // ignore paths with zero metric
@@ -188,11 +382,6 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_b
          }
       beta[i][x1] = this_beta;
       }
-#if DEBUG>=3
-   if (tp_states > 0 && count != tp_states)
-   std::cerr << "DEBUG (work_beta): i=" << i << ", path count="
-   << count << std::endl;
-#endif
    }
 
 template <class receiver_t, class sig, class real, class real2,
@@ -200,8 +389,11 @@ template <class receiver_t, class sig, class real, class real2,
 void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_message_app(
       array1vr_t& ptable, const int i) const
    {
+   // determine the range of states that may have a non-zero metric
+   const int x1min = thresholding ? frontier[i].x_min : mtau_min;
+   const int x1max = thresholding ? frontier[i].x_max : mtau_max;
    // determine the strongest path at this point
-   const real threshold = get_threshold(alpha, i, mtau_min, mtau_max, th_outer,
+   const real threshold = get_threshold(alpha, i, x1min, x1max, th_outer,
          tp_states);
    for (int d = 0; d < q; d++)
       {
@@ -210,7 +402,7 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_m
 #endif
       // initialize result holder
       real p = 0;
-      for (int x1 = mtau_min; x1 <= mtau_max; x1++)
+      for (int x1 = x1min; x1 <= x1max; x1++)
          {
          // cache this alpha value in a register
          const real this_alpha = alpha[i][x1];
@@ -290,9 +482,25 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::alloca
        * d in [0, q-1]
        * deltax in [mn_min, mn_max]
        */
-      gamma.global.resize(
+      const boost::detail::multi_array::extent_gen<4> extents =
             boost::extents[N][range(mtau_min, mtau_max + 1)][q][range(mn_min,
-                  mn_max + 1)]);
+                  mn_max + 1)];
+      switch (gamma_format)
+         {
+         case Base::gamma_format_float:
+            gamma.global_float.resize(extents);
+            break;
+         case Base::gamma_format_log16:
+            gamma.global_log16.resize(extents);
+            break;
+         default:
+            gamma.global.resize(extents);
+            break;
+         }
+      // compressed formats also need a scale factor for each state
+      if (gamma_format != Base::gamma_format_real)
+         gamma.scale.resize(
+               boost::extents[N][range(mtau_min, mtau_max + 1)]);
       gamma.local.resize(boost::extents[0][0][0]);
       }
    else
@@ -351,8 +559,7 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::alloca
    bytes_used += sizeof(bool) * cached.local.num_elements();
    bytes_used += sizeof(real) * alpha.num_elements();
    bytes_used += sizeof(real) * beta.num_elements();
-   bytes_used += sizeof(real) * gamma.global.num_elements();
-   bytes_used += sizeof(real) * gamma.local.num_elements();
+   bytes_used += get_gamma_bytes();
    std::cerr << "FBA Memory Usage: " << bytes_used / double(1 << 20) << "MiB"
          << std::endl;
    // revert cerr to original format
@@ -402,8 +609,15 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::free()
    beta.resize(boost::extents[0][0]);
    gamma.global.resize(boost::extents[0][0][0][0]);
    gamma.local.resize(boost::extents[0][0][0]);
+   gamma.global_float.resize(boost::extents[0][0][0][0]);
+   gamma.global_log16.resize(boost::extents[0][0][0][0]);
+   gamma.scale.resize(boost::extents[0][0]);
    cached.global.resize(boost::extents[0][0]);
    cached.local.resize(boost::extents[0]);
+   std::vector<frontier_t>().swap(frontier);
+   batch.alpha.resize(boost::extents[0][0][0]);
+   batch.beta.resize(boost::extents[0][0][0]);
+   batch.gamma.resize(boost::extents[0][0][0][0][0]);
    // flag the state of the arrays
    initialised = false;
    }
@@ -417,7 +631,20 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::reset_
    // initialise array and cache flags
    if (globalstore)
       {
-      gamma.global = real(0);
+      switch (gamma_format)
+         {
+         case Base::gamma_format_float:
+            gamma.global_float = 0;
+            gamma.scale = real(0);
+            break;
+         case Base::gamma_format_log16:
+            gamma.global_log16 = 0;
+            gamma.scale = real(0);
+            break;
+         default:
+            gamma.global = real(0);
+            break;
+         }
       cached.global = false;
       }
    else
@@ -432,6 +659,44 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::reset_
 #endif
    }
 
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::print_gamma_storage(
+      std::ostream& sout) const
+   {
+   // set required format, storing previous settings
+   const std::ios::fmtflags old_flags = sout.flags();
+   sout.setf(std::ios::fixed, std::ios::floatfield);
+   const std::streamsize old_precision = sout.precision(1);
+   sout << "FBA Gamma Storage: " << get_gamma_bytes() / double(1 << 20)
+         << "MiB";
+   switch (gamma_format)
+      {
+      case Base::gamma_format_float:
+         sout << " (float)";
+         break;
+      case Base::gamma_format_log16:
+         sout << " (log16)";
+         break;
+      default:
+         sout << " (real)";
+         break;
+      }
+#ifndef NDEBUG
+   if (gamma_stored > 0)
+      {
+      sout << ", " << 100 * double(gamma_zeros) / double(gamma_stored)
+            << "% zero";
+      sout.setf(std::ios::scientific, std::ios::floatfield);
+      sout << ", max relative error " << gamma_error;
+      }
+#endif
+   sout << std::endl;
+   // revert to original format
+   sout.precision(old_precision);
+   sout.flags(old_flags);
+   }
+
 template <class receiver_t, class sig, class real, class real2,
       bool thresholding, bool lazy, bool globalstore>
 void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::print_gamma(
@@ -447,7 +712,7 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::print_
          for (int x = mtau_min; x <= mtau_max; x++)
             {
             for (int deltax = mn_min; deltax <= mn_max; deltax++)
-               sout << '\t' << gamma.global[i][x][d][deltax];
+               sout << '\t' << gamma_storage_entry(d, i, x, deltax);
             sout << std::endl;
             }
          }
@@ -492,6 +757,7 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_a
    // NOTE: technically unnecessary, as we initialize this_beta for every value
    alpha = real(0);
    beta = real(0);
+   reset_frontier();
    // set initial and final drift distribution
    for (int x = mtau_min; x <= mtau_max; x++)
       {
@@ -501,15 +767,17 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_a
    // normalize
    normalize_alpha(0);
    normalize_beta(N);
+   prune_alpha(0);
    // compute remaining matrix values
    for (int i = 1; i <= N; i++)
       {
       std::cerr << progress.update(i - 1, N);
-      // compute partial result
+      // compute partial result and normalize
+      // NOTE: alpha needs to be pruned before it is used in computing beta
       work_alpha(i);
-      work_beta(N - i);
-      // normalize
       normalize_alpha(i);
+      prune_alpha(i);
+      work_beta(N - i);
       normalize_beta(N - i);
       }
    std::cerr << progress.update(N, N);
@@ -561,11 +829,13 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_a
    libbase::pacifier progress("FBA Alpha");
    // initialise array:
    alpha = real(0);
+   reset_frontier();
    // set initial drift distribution
    for (int x = mtau_min; x <= mtau_max; x++)
       alpha[0][x] = real(sof_prior(x - mtau_min));
    // normalize
    normalize_alpha(0);
+   prune_alpha(0);
    // compute remaining matrix values
    for (int i = 1; i <= N; i++)
       {
@@ -587,6 +857,7 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_a
       work_alpha(i);
       // normalize
       normalize_alpha(i);
+      prune_alpha(i);
       }
    std::cerr << progress.update(N, N);
 #if DEBUG>=4
@@ -649,6 +920,241 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_b
 #endif
    }
 
+// decode functions - batch path
+
+/*! \brief Memory allocator for batch decoding of 'W' frames
+ * Frames are kept in the last index of each array, so that the recursions
+ * can work on all frames together in their innermost loops.
+ */
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::allocate_batch(const int W)
+   {
+   typedef boost::multi_array_types::extent_range range;
+   batch.alpha.resize(
+         boost::extents[N + 1][range(mtau_min, mtau_max + 1)][W]);
+   batch.beta.resize(boost::extents[N + 1][range(mtau_min, mtau_max + 1)][W]);
+   batch.gamma.resize(
+         boost::extents[N][range(mtau_min, mtau_max + 1)][q][range(mn_min,
+               mn_max + 1)][W]);
+   batch.temp.init(W);
+   }
+
+/*! \brief Normalize the given row of a batch metric, for each frame
+ * This follows libbase::normalize_row() for each frame.
+ */
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::normalize_batch(
+      array3r_t& metric, const int i)
+   {
+   const int W = batch.temp.size();
+   // determine scale for each frame
+   for (int w = 0; w < W; w++)
+      batch.temp(w) = 0;
+   for (int x = mtau_min; x <= mtau_max; x++)
+      {
+      const real* m = &metric[i][x][0];
+      for (int w = 0; w < W; w++)
+         batch.temp(w) += m[w];
+      }
+   // check for numerical underflow
+   for (int w = 0; w < W; w++)
+      {
+      if (batch.temp(w) > real(0))
+         {
+         const real scale = real(1) / batch.temp(w);
+         for (int x = mtau_min; x <= mtau_max; x++)
+            metric[i][x][w] *= scale;
+         }
+      else
+         {
+         for (int x = mtau_min; x <= mtau_max; x++)
+            metric[i][x][w] = real(1);
+         }
+      }
+   }
+
+/*! \brief Copy the gamma metric for the current frame to batch lane 'w'
+ * The metric needs to have been computed in global storage first.
+ */
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::copy_gamma_batch(
+      const int w)
+   {
+   for (int i = 0; i < N; i++)
+      for (int x = mtau_min; x <= mtau_max; x++)
+         for (int d = 0; d < q; d++)
+            for (int deltax = mn_min; deltax <= mn_max; deltax++)
+               batch.gamma[i][x][d][deltax][w] = gamma_storage_entry(d, i, x,
+                     deltax);
+   }
+
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_alpha_batch(
+      const int i)
+   {
+   const int W = batch.temp.size();
+   real* change = &batch.temp(0);
+   for (int x1 = mtau_min; x1 <= mtau_max; x1++)
+      {
+      const real* prev_alpha = &batch.alpha[i - 1][x1][0];
+      // limits on deltax can be combined as (c.f. allocate() for details):
+      //   x2-x1 <= mn_max
+      //   x2-x1 >= mn_min
+      const int x2min = std::max(mtau_min, mn_min + x1);
+      const int x2max = std::min(mtau_max, mn_max + x1);
+      for (int x2 = x2min; x2 <= x2max; x2++)
+         {
+         // NOTE: summation order is as in work_alpha(), for each frame
+         for (int w = 0; w < W; w++)
+            change[w] = 0;
+         for (int d = 0; d < q; d++)
+            {
+            const real* g = &batch.gamma[i - 1][x1][d][x2 - x1][0];
+            for (int w = 0; w < W; w++)
+               change[w] += prev_alpha[w] * g[w];
+            }
+         real* this_alpha = &batch.alpha[i][x2][0];
+         for (int w = 0; w < W; w++)
+            this_alpha[w] += change[w];
+         }
+      }
+   }
+
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_beta_batch(
+      const int i)
+   {
+   const int W = batch.temp.size();
+   for (int x1 = mtau_min; x1 <= mtau_max; x1++)
+      {
+      real* this_beta = &batch.beta[i][x1][0];
+      for (int w = 0; w < W; w++)
+         this_beta[w] = 0;
+      // limits on deltax can be combined as (c.f. allocate() for details):
+      //   x2-x1 <= mn_max
+      //   x2-x1 >= mn_min
+      const int x2min = std::max(mtau_min, mn_min + x1);
+      const int x2max = std::min(mtau_max, mn_max + x1);
+      for (int x2 = x2min; x2 <= x2max; x2++)
+         {
+         const real* next_beta = &batch.beta[i + 1][x2][0];
+         for (int d = 0; d < q; d++)
+            {
+            const real* g = &batch.gamma[i][x1][d][x2 - x1][0];
+            for (int w = 0; w < W; w++)
+               this_beta[w] += next_beta[w] * g[w];
+            }
+         }
+      }
+   }
+
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_message_app_batch(
+      libbase::vector<array1vr_t>& ptable, const int i)
+   {
+   const int W = batch.temp.size();
+   real* p = &batch.temp(0);
+   for (int d = 0; d < q; d++)
+      {
+      // initialize result holder
+      for (int w = 0; w < W; w++)
+         p[w] = 0;
+      for (int x1 = mtau_min; x1 <= mtau_max; x1++)
+         {
+         const real* this_alpha = &batch.alpha[i][x1][0];
+         // limits on deltax can be combined as (c.f. allocate() for details):
+         //   x2-x1 <= mn_max
+         //   x2-x1 >= mn_min
+         const int x2min = std::max(mtau_min, mn_min + x1);
+         const int x2max = std::min(mtau_max, mn_max + x1);
+         for (int x2 = x2min; x2 <= x2max; x2++)
+            {
+            const real* next_beta = &batch.beta[i + 1][x2][0];
+            const real* g = &batch.gamma[i][x1][d][x2 - x1][0];
+            for (int w = 0; w < W; w++)
+               p[w] += this_alpha[w] * next_beta[w] * g[w];
+            }
+         }
+      // store result
+      for (int w = 0; w < W; w++)
+         ptable(w)(i)(d) = p[w];
+      }
+   }
+
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_alpha_and_beta_batch(
+      const array1vd_t& sof_prior, const array1vd_t& eof_prior)
+   {
+   const int W = batch.temp.size();
+   libbase::pacifier progress("FBA Alpha + Beta (batch)");
+   // initialise arrays
+   batch.alpha = real(0);
+   // set initial and final drift distribution
+   for (int x = mtau_min; x <= mtau_max; x++)
+      for (int w = 0; w < W; w++)
+         {
+         batch.alpha[0][x][w] = real(sof_prior(w)(x - mtau_min));
+         batch.beta[N][x][w] = real(eof_prior(w)(x - mtau_min));
+         }
+   // normalize
+   normalize_batch(batch.alpha, 0);
+   normalize_batch(batch.beta, N);
+   // compute remaining matrix values
+   for (int i = 1; i <= N; i++)
+      {
+      std::cerr << progress.update(i - 1, N);
+      // compute partial result
+      work_alpha_batch(i);
+      work_beta_batch(N - i);
+      // normalize
+      normalize_batch(batch.alpha, i);
+      normalize_batch(batch.beta, N - i);
+      }
+   std::cerr << progress.update(N, N);
+   }
+
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::work_results_batch(
+      libbase::vector<array1vr_t>& ptable, array1vr_t& sof_post,
+      array1vr_t& eof_post)
+   {
+   const int W = batch.temp.size();
+   libbase::pacifier progress("FBA Results (batch)");
+   // Initialise result vectors
+   ptable.init(W);
+   for (int w = 0; w < W; w++)
+      libbase::allocate(ptable(w), N, q);
+   for (int i = 0; i < N; i++)
+      {
+      std::cerr << progress.update(i, N);
+      // compute partial result
+      work_message_app_batch(ptable, i);
+      }
+   if (N > 0)
+      std::cerr << progress.update(N, N);
+   // compute APPs of sof/eof state values
+   sof_post.init(W);
+   eof_post.init(W);
+   for (int w = 0; w < W; w++)
+      {
+      sof_post(w).init(mtau_max - mtau_min + 1);
+      eof_post(w).init(mtau_max - mtau_min + 1);
+      for (int x = mtau_min; x <= mtau_max; x++)
+         {
+         sof_post(w)(x - mtau_min) = batch.alpha[0][x][w] * batch.beta[0][x][w];
+         eof_post(w)(x - mtau_min) = batch.alpha[N][x][w] * batch.beta[N][x][w];
+         }
+      }
+   }
+
 // User procedures
 
 // Initialization
@@ -698,6 +1204,30 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::init(
    this->tp_states = tp_states;
    }
 
+/*!
+ * \brief Set up storage format for gamma metric in global storage mode
+ * \param[in] format Storage format for gamma values
+ * \param[in] threshold Fraction of largest gamma value at each state below
+ *                      which values are stored as zero
+ *
+ * This has no effect in local storage mode, where memory use is small.
+ */
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::set_gamma_format(
+      typename Base::gamma_format_t format,
+      double threshold)
+   {
+   assertalways(format >= Base::gamma_format_real
+         && format < Base::gamma_format_undefined);
+   assertalways(threshold >= 0 && threshold < 1);
+   // if the storage format has changed, release memory
+   if (initialised && format != gamma_format)
+      free();
+   gamma_format = format;
+   gamma_threshold = threshold;
+   }
+
 /*!
  * \brief Frame decode cycle
  * \param[in] collector Reference to (instrumented) results collector object
@@ -760,6 +1290,12 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::decode
    assertalways(r.size() == tau + mtau_max - mtau_min);
    assertalways(sof_prior.size() == mtau_max - mtau_min + 1);
    assertalways(eof_prior.size() == mtau_max - mtau_min + 1);
+#ifndef NDEBUG
+   // reset gamma storage statistics
+   gamma_stored = 0;
+   gamma_zeros = 0;
+   gamma_error = 0;
+#endif
 
    // Gamma
    if (!lazy && globalstore)
@@ -813,10 +1349,7 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::decode
    // Add memory usage
    collector.add_timer(sizeof(real) * alpha.num_elements(), "m_alpha");
    collector.add_timer(sizeof(real) * beta.num_elements(), "m_beta");
-   collector.add_timer(
-         sizeof(real)
-               * (gamma.global.num_elements() + gamma.local.num_elements()),
-         "m_gamma");
+   collector.add_timer(get_gamma_bytes(), "m_gamma");
 
 #ifndef NDEBUG
    // show cache statistics if applicable
@@ -828,9 +1361,91 @@ void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::decode
       std::cerr << "FBA Cache Usage: " << 100 * usage << "%" << std::endl;
       std::cerr << "FBA Cache Reuse: " << reuse << "×" << std::endl;
       }
+   // show gamma storage statistics if applicable
+   if (globalstore)
+      print_gamma_storage(std::cerr);
 #endif
    }
 
+/*!
+ * \brief Decode a batch of independent frames in lock-step
+ *
+ * The gamma metric is computed for each frame in turn (with the frame's own
+ * encoding table) and copied to the batch storage; the forward and backward
+ * recursions and the results are then computed for all frames together, with
+ * frames in the innermost loop. Results for each frame are the same as those
+ * obtained by decode().
+ *
+ * This is only possible when gamma is pre-computed in global storage without
+ * path thresholding; otherwise frames are decoded one after the other.
+ */
+template <class receiver_t, class sig, class real, class real2,
+      bool thresholding, bool lazy, bool globalstore>
+void fba2<receiver_t, sig, real, real2, thresholding, lazy, globalstore>::decode_batch(
+      libcomm::instrumented& collector,
+      const libbase::vector<array2vs_t>& encoding_table,
+      const libbase::vector<array1s_t>& r, const array1vd_t& sof_prior,
+      const array1vd_t& eof_prior, const libbase::vector<array1vd_t>& app,
+      libbase::vector<array1vr_t>& ptable, array1vr_t& sof_post,
+      array1vr_t& eof_post, const int offset)
+   {
+   if (lazy || !globalstore || thresholding)
+      {
+      Base::decode_batch(collector, encoding_table, r, sof_prior, eof_prior,
+            app, ptable, sof_post, eof_post, offset);
+      return;
+      }
+   const int W = r.size();
+   assertalways(W > 0);
+   assertalways(encoding_table.size() == W);
+   assertalways(sof_prior.size() == W && eof_prior.size() == W);
+   assertalways(app.size() == W);
+   // Initialise memory if necessary
+   if (!initialised)
+      allocate();
+   allocate_batch(W);
+   // Validate offset
+   assertalways(offset == -mtau_min);
+
+   // Gamma
+   libbase::cputimer tg("t_gamma");
+   for (int w = 0; w < W; w++)
+      {
+      // set up for this frame
+      init(encoding_table(w));
+      // validate sizes
+      assertalways(r(w).size() == tau + mtau_max - mtau_min);
+      assertalways(sof_prior(w).size() == mtau_max - mtau_min + 1);
+      assertalways(eof_prior(w).size() == mtau_max - mtau_min + 1);
+      // compute in global storage, and copy to batch storage
+      work_gamma(r(w), app(w));
+      copy_gamma_batch(w);
+      }
+   collector.add_timer(tg);
+   // Alpha + Beta
+   libbase::cputimer tab("t_alpha+beta");
+   work_alpha_and_beta_batch(sof_prior, eof_prior);
+   collector.add_timer(tab);
+   // Compute results
+   libbase::cputimer tr("t_results");
+   work_results_batch(ptable, sof_post, eof_post);
+   collector.add_timer(tr);
+
+   // Add values for limits that depend on channel conditions
+   collector.add_timer(mtau_min, "c_mtau_min");
+   collector.add_timer(mtau_max, "c_mtau_max");
+   collector.add_timer(mn_min, "c_mn_min");
+   collector.add_timer(mn_max, "c_mn_max");
+   collector.add_timer(m1_min, "c_m1_min");
+   collector.add_timer(m1_max, "c_m1_max");
+   // Add memory usage
+   collector.add_timer(sizeof(real) * batch.alpha.num_elements(), "m_alpha");
+   collector.add_timer(sizeof(real) * batch.beta.num_elements(), "m_beta");
+   collector.add_timer(
+         get_gamma_bytes() + sizeof(real) * batch.gamma.num_elements(),
+         "m_gamma");
+   }
+
 /*!
  * \brief Get the posterior channel drift pdf at codeword boundaries
  * \param[out] pdftable Posterior Probabilities for codeword boundaries
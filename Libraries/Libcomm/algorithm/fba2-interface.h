@@ -57,6 +57,12 @@ public:
    typedef libbase::vector<real> array1r_t;
    typedef libbase::vector<array1d_t> array1vd_t;
    typedef libbase::vector<array1r_t> array1vr_t;
+   enum gamma_format_t {
+      gamma_format_real = 0, //!< gamma stored as 'real'
+      gamma_format_float, //!< gamma stored as float, relative to state maximum
+      gamma_format_log16, //!< gamma stored as 16-bit log, relative to state maximum
+      gamma_format_undefined
+   };
    // @}
 public:
    /*! \name Constructors / Destructors */
@@ -65,17 +71,38 @@ public:
       }
    // @}
 
+   //! Determine size of a gamma entry in global storage mode (in bytes)
+   static int get_gamma_entry_size(gamma_format_t format)
+      {
+      switch (format)
+         {
+         case gamma_format_real:
+            return sizeof(real);
+         case gamma_format_float:
+            return sizeof(float);
+         case gamma_format_log16:
+            return sizeof(libbase::int16u);
+         default:
+            failwith("Unknown gamma storage format");
+            return 0;
+         }
+      }
+
    //! Determine memory required for global storage mode (in MiB)
    static int get_memory_required(int N, int q, int mtau_min, int mtau_max,
-         int mn_min, int mn_max)
+         int mn_min, int mn_max, gamma_format_t format = gamma_format_real)
       {
       // determine memory required
       // NOTE: do all computations at 64-bit, or we get intermediate overflow!
-      libbase::int64u bytes_required = sizeof(real);
+      libbase::int64u bytes_required = get_gamma_entry_size(format);
       bytes_required *= q;
       bytes_required *= N;
       bytes_required *= (mtau_max - mtau_min + 1);
       bytes_required *= (mn_max - mn_min + 1);
+      // compressed formats also keep a scale factor for each state
+      if (format != gamma_format_real)
+         bytes_required += libbase::int64u(sizeof(real)) * N
+               * (mtau_max - mtau_min + 1);
       bytes_required >>= 20;
       return int(bytes_required);
       }
@@ -92,12 +119,47 @@ public:
     * Needs to be done before every frame.
     */
    virtual void init(const array2vs_t& encoding_table) const = 0;
+   /*! \brief Set up storage format for gamma metric in global storage mode
+    * The threshold is a fraction of the largest gamma value for each state,
+    * below which entries are taken as zero. Only the full-precision format
+    * without thresholding is supported by default.
+    */
+   virtual void set_gamma_format(gamma_format_t format, double threshold)
+      {
+      assertalways(format == gamma_format_real && threshold == 0);
+      }
 
    // decode functions
    virtual void decode(libcomm::instrumented& collector, const array1s_t& r,
          const array1d_t& sof_prior, const array1d_t& eof_prior,
          const array1vd_t& app, array1vr_t& ptable, array1r_t& sof_post,
          array1r_t& eof_post, const int offset) = 0;
+   /*! \brief Decode a batch of independent frames
+    * Each frame has its own encoding table, received sequence, and priors;
+    * all other parameters are as set up by init(). By default, frames are
+    * simply decoded one after the other.
+    *
+    * \note After this call, get_drift_pdf() does not necessarily refer to
+    *       any of the frames in the batch.
+    */
+   virtual void decode_batch(libcomm::instrumented& collector,
+         const libbase::vector<array2vs_t>& encoding_table,
+         const libbase::vector<array1s_t>& r, const array1vd_t& sof_prior,
+         const array1vd_t& eof_prior, const libbase::vector<array1vd_t>& app,
+         libbase::vector<array1vr_t>& ptable, array1vr_t& sof_post,
+         array1vr_t& eof_post, const int offset)
+      {
+      const int W = r.size();
+      ptable.init(W);
+      sof_post.init(W);
+      eof_post.init(W);
+      for (int w = 0; w < W; w++)
+         {
+         init(encoding_table(w));
+         decode(collector, r(w), sof_prior(w), eof_prior(w), app(w),
+               ptable(w), sof_post(w), eof_post(w), offset);
+         }
+      }
    virtual void get_drift_pdf(array1r_t& pdf, const int i) const = 0;
    virtual void get_drift_pdf(array1vr_t& pdftable) const = 0;
 
@@ -30,6 +30,7 @@
 #include <cmath>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 namespace libcomm {
 
@@ -58,6 +59,7 @@ template <class receiver_t, class sig, class real, class real2,
 class fba2 : public fba2_interface<sig, real, real2> {
 public:
    /*! \name Type definitions */
+   typedef fba2_interface<sig, real, real2> Base;
    typedef libbase::vector<int> array1i_t;
    typedef libbase::vector<sig> array1s_t;
    typedef libbase::matrix<array1s_t> array2vs_t;
@@ -68,6 +70,9 @@ public:
    typedef boost::assignable_multi_array<real, 2> array2r_t;
    typedef boost::assignable_multi_array<real, 3> array3r_t;
    typedef boost::assignable_multi_array<real, 4> array4r_t;
+   typedef boost::assignable_multi_array<real, 5> array5r_t;
+   typedef boost::assignable_multi_array<float, 4> array4f_t;
+   typedef boost::assignable_multi_array<libbase::int16u, 4> array4c_t;
    typedef boost::assignable_multi_array<bool, 1> array1b_t;
    typedef boost::assignable_multi_array<bool, 2> array2b_t;
    // @}
@@ -79,11 +84,27 @@ private:
    mutable struct {
       array4r_t global; // indices (i,x,d,deltax)
       array3r_t local; // indices (x,d,deltax)
+      array4f_t global_float; // indices (i,x,d,deltax), relative to scale
+      array4c_t global_log16; // indices (i,x,d,deltax), relative to scale
+      array2r_t scale; // indices (i,x)
    } gamma; //!< Receiver metric
    mutable struct {
       array2b_t global; // indices (i,x)
       array1b_t local; // indices (x)
    } cached; //!< Flag for caching of receiver metric
+   struct frontier_t {
+      int x_min; //!< Lowest state that may have a non-zero forward metric
+      int x_max; //!< Highest state that may have a non-zero forward metric
+      bool pruned; //!< Flag indicating that states below a threshold were dropped
+      std::vector<int> states; //!< Surviving states, in increasing order
+   };
+   std::vector<frontier_t> frontier; //!< Surviving states at each index, when thresholding
+   struct {
+      array3r_t alpha; // indices (i,x,w)
+      array3r_t beta; // indices (i,x,w)
+      array5r_t gamma; // indices (i,x,d,deltax,w)
+      array1r_t temp; // indices (w)
+   } batch; //!< Metrics for batch decoding, with frames in the last index
    mutable array1i_t cw_length; //!< Codeword 'i' length
    mutable array1i_t cw_start; //!< Codeword 'i' start
    mutable int tau; //!< Frame length (all codewords in sequence)
@@ -93,6 +114,9 @@ private:
 #ifndef NDEBUG
    mutable int gamma_calls; //!< Number of calls requesting gamma values
    mutable int gamma_misses; //!< Number of cache misses in such calls
+   mutable libbase::int64u gamma_stored; //!< Number of gamma values in global storage
+   mutable libbase::int64u gamma_zeros; //!< Number of such values stored as zero
+   mutable double gamma_error; //!< Largest relative error for such values
    static int scale_calls; //!< Number of calls requesting metric scale factor
    static int scale_zeros; //!< Number of zero scale values in such calls
 #endif
@@ -109,37 +133,61 @@ private:
    int mn_max; //!< The largest positive drift within a q-ary symbol is \f$ m_n^{+} \f$
    int m1_min; //!< The largest negative drift over a single channel symbol is \f$ m_1^{-} \f$
    int m1_max; //!< The largest positive drift over a single channel symbol is \f$ m_1^{+} \f$
+   typename Base::gamma_format_t gamma_format; //!< Storage format for gamma in global storage mode
+   double gamma_threshold; //!< Fraction of state maximum below which gamma is stored as zero
+   // @}
+   /*! \name Hardwired parameters */
+   static const double log16_step; //!< Resolution of 16-bit log format (in nats)
    // @}
 private:
    /*! \name Internal functions - computer */
-   //! Get a reference to the corresponding gamma storage entry
-   real& gamma_storage_entry(int d, int i, int x, int deltax) const
+   //! Get the value of the corresponding gamma storage entry
+   real gamma_storage_entry(int d, int i, int x, int deltax) const
       {
-      if (globalstore)
-         return gamma.global[i][x][d][deltax];
-      else
+      if (!globalstore)
          return gamma.local[x][d][deltax];
+      switch (gamma_format)
+         {
+         case Base::gamma_format_float:
+            return real(double(gamma.global_float[i][x][d][deltax]))
+                  * gamma.scale[i][x];
+         case Base::gamma_format_log16:
+            return real(log16_table()[gamma.global_log16[i][x][d][deltax]])
+                  * gamma.scale[i][x];
+         default:
+            return gamma.global[i][x][d][deltax];
+         }
       }
+   //! Memory used for gamma storage (in bytes)
+   size_t get_gamma_bytes() const
+      {
+      return sizeof(real)
+            * (gamma.global.num_elements() + gamma.local.num_elements()
+                  + gamma.scale.num_elements())
+            + sizeof(float) * gamma.global_float.num_elements()
+            + sizeof(libbase::int16u) * gamma.global_log16.num_elements();
+      }
+   //! Table of values represented by each code in 16-bit log format
+   static const double* log16_table();
+   //! Store gamma values for all symbols at the indicated state
+   void store_gamma(const array1vr_t& ptable, int i, int x) const;
    //! Fill indicated storage entries for gamma metric - batch interface
    void fill_gamma_storage_batch(const array1s_t& r, const array1vd_t& app, int i, int x) const
       {
       // allocate space for results
-      static array1r_t ptable;
-      ptable.init(mn_max - mn_min + 1);
+      static array1vr_t ptable;
+      ptable.init(q);
+      for (int d = 0; d < q; d++)
+         ptable(d).init(mn_max - mn_min + 1);
       // determine received segment to extract
       // n * i = offset to start of current codeword
       // -mtau_min = offset to zero drift in 'r'
       const int start = cw_start(i) + x - mtau_min;
       const int length = std::min(cw_length(i) + mn_max, r.size() - start);
-      // for each symbol value
-      for (int d = 0; d < q; d++)
-         {
-         // call batch receiver method
-         receiver.R(d, i, r.extract(start, length), app, ptable);
-         // store in corresponding place in storage
-         for (int deltax = mn_min; deltax <= mn_max; deltax++)
-            gamma_storage_entry(d, i, x, deltax) = ptable(deltax - mn_min);
-         }
+      // call batch receiver method, for all symbol values
+      receiver.R(i, r.extract(start, length), app, ptable);
+      // store in corresponding place in storage
+      store_gamma(ptable, i, x);
       }
    /*! \brief Fill indicated cache entries for gamma metric as needed
     *
@@ -208,6 +256,8 @@ private:
       {
       libbase::normalize_row(beta, i, mtau_min, mtau_max);
       }
+   void reset_frontier();
+   void prune_alpha(const int i);
    // decode functions - partial computations
    void work_gamma(const array1s_t& r, const array1vd_t& app,
          const int i) const
@@ -215,6 +265,7 @@ private:
       for (int x = mtau_min; x <= mtau_max; x++)
          fill_gamma_storage_batch(r, app, i, x);
       }
+   void work_alpha(const int i, const int x1, const real prev_alpha);
    void work_alpha(const int i);
    void work_beta(const int i);
    void work_message_app(array1vr_t& ptable, const int i) const;
@@ -228,6 +279,7 @@ private:
    // helper methods
    void reset_cache() const;
    void print_gamma(std::ostream& sout) const;
+   void print_gamma_storage(std::ostream& sout) const;
    // decode functions - global path
    void work_gamma(const array1s_t& r, const array1vd_t& app);
    void work_alpha_and_beta(const array1d_t& sof_prior,
@@ -238,12 +290,26 @@ private:
    void work_alpha(const array1d_t& sof_prior);
    void work_beta_and_results(const array1d_t& eof_prior, array1vr_t& ptable,
          array1r_t& sof_post, array1r_t& eof_post);
+   // decode functions - batch path
+   void allocate_batch(const int W);
+   void normalize_batch(array3r_t& metric, const int i);
+   void copy_gamma_batch(const int w);
+   void work_alpha_batch(const int i);
+   void work_beta_batch(const int i);
+   void work_message_app_batch(libbase::vector<array1vr_t>& ptable,
+         const int i);
+   void work_alpha_and_beta_batch(const array1vd_t& sof_prior,
+         const array1vd_t& eof_prior);
+   void work_results_batch(libbase::vector<array1vr_t>& ptable,
+         array1vr_t& sof_post, array1vr_t& eof_post);
    // @}
 public:
    /*! \name Constructors / Destructors */
    //! Default constructor
    fba2() :
-         initialised(false)
+         initialised(false), gamma_format(
+               Base::gamma_format_real), gamma_threshold(
+               0)
       {
       }
    //! Virtual destructor
@@ -284,12 +350,21 @@ public:
       // Set up receiver with new encoding table
       this->receiver.init(encoding_table);
       }
+   void set_gamma_format(
+         typename Base::gamma_format_t format,
+         double threshold);
 
    // decode functions
    void decode(libcomm::instrumented& collector, const array1s_t& r,
          const array1d_t& sof_prior, const array1d_t& eof_prior,
          const array1vd_t& app, array1vr_t& ptable, array1r_t& sof_post,
          array1r_t& eof_post, const int offset);
+   void decode_batch(libcomm::instrumented& collector,
+         const libbase::vector<array2vs_t>& encoding_table,
+         const libbase::vector<array1s_t>& r, const array1vd_t& sof_prior,
+         const array1vd_t& eof_prior, const libbase::vector<array1vd_t>& app,
+         libbase::vector<array1vr_t>& ptable, array1vr_t& sof_post,
+         array1vr_t& eof_post, const int offset);
    void get_drift_pdf(array1r_t& pdf, const int i) const
       {
       work_state_app(pdf, i);
@@ -300,6 +300,27 @@ public:
                ptable(i, j)(x) = this->pdf(tx(i, j)(x), rx(i, j));
             }
       }
+   /*!
+    * \brief Determine the likelihoods of a single received symbol
+    * \param[in]  tx       Set of possible transmitted symbols
+    * \param[in]  rx       Received modulation symbol
+    * \param[out] ptable   Likelihoods corresponding to each possible
+    * transmitted symbol
+    *
+    * This allows time-variant modulation schemes to work out the possible
+    * transmitted symbols one position at a time, rather than setting up
+    * the full set beforehand.
+    *
+    * \note Used by ssis
+    */
+   template <class A>
+   void receive(const array1s_t& tx, const S& rx, libbase::vector<A>& ptable) const
+      {
+      const int M = tx.size();
+      ptable.init(M);
+      for (int x = 0; x < M; x++)
+         ptable(x) = A(this->pdf(tx(x), rx));
+      }
 };
 
 /*!
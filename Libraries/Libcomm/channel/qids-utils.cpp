@@ -21,8 +21,16 @@
 
 #include "qids-utils.h"
 #include "itfunc.h"
+#include "sysvar.h"
+#include <boost/shared_ptr.hpp>
 #include <exception>
+#include <stdexcept>
 #include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
 
 namespace libcomm {
 
@@ -74,207 +82,254 @@ double qids_utils::compute_drift_prob_davey(int m, int T, double Pi, double Pd)
    return this_p;
    }
 
-/*! \copydoc qids_utils::compute_drift_prob_exact()
- *
- * Non-degenerate case: Pi > 0, Pd > 0
- *
- * The required probability Pr{ S_T = m } is calculated as:
- *
- * sum for j=j0..T of
- *
- *    p_j = Pt^T Pi^m Pf^j C(T, j) C(T+m+j-1, m+j)
- *
- * where j0 = max(-m,0),
- *       Pf = Pi Pd / Pt,
- *       Pt = 1 - Pi - Pd,
- * and the binomial coefficient is expressed as
- *    C(n,k) = n! / [ k! (n-k)! ] for k ≤ n
- *           = n(n-1)...(n-k-1) / k(k-1)...1
- *           = 0 for k > n
- *
- * Note that:
- * a) the summation is empty if j0 > T, resulting in zero probability
- * b) the first binomial coefficient is always non-zero
- * c) the second b.c. is non-zero if T-1 >= 0, or equivalently T > 0
- *
- * By expanding the binomial coefficients using factorials, note also that:
- *
- *    p_j = p_{j-1} . Pf . (T+m+j-1) . (T-j+1)
- *                           (m+j)        j
+namespace {
+
+/*!
+ * \brief Exact drift pdf after transmitting a given number of symbols
  *
- * This allows successive factors to be determined easily from previous ones.
- * The initial factor required is the one at j0, determined as:
+ * Holds the probability of drift m for lo <= m < lo + p.size(); outside
+ * this range the probability is too small to represent.
+ */
+struct drift_table {
+   int lo;
+   std::vector<double> p;
+};
+
+//! Key for drift pdf cache
+struct drift_key {
+   int T;
+   double Pi;
+   double Pd;
+   bool operator<(const drift_key& x) const
+      {
+      if (T != x.T)
+         return T < x.T;
+      if (Pi != x.Pi)
+         return Pi < x.Pi;
+      return Pd < x.Pd;
+      }
+};
+
+//! Key for state space limits cache
+struct limits_key {
+   int kind; //!< 0 for upper/lower limits, 1 for maximum absolute drift
+   int T;
+   double Pi;
+   double Pd;
+   double Pr;
+   int offset;
+   int size; //!< Size of start-of-frame pdf
+   libbase::int64u hash; //!< Hash of start-of-frame pdf
+   bool operator<(const limits_key& x) const
+      {
+      if (kind != x.kind)
+         return kind < x.kind;
+      if (T != x.T)
+         return T < x.T;
+      if (Pi != x.Pi)
+         return Pi < x.Pi;
+      if (Pd != x.Pd)
+         return Pd < x.Pd;
+      if (Pr != x.Pr)
+         return Pr < x.Pr;
+      if (offset != x.offset)
+         return offset < x.offset;
+      if (size != x.size)
+         return size < x.size;
+      return hash < x.hash;
+      }
+};
+
+typedef std::map<drift_key, boost::shared_ptr<const drift_table> > drift_cache_t;
+typedef std::map<limits_key, std::pair<int, int> > limits_cache_t;
+
+//! Largest number of drift pdfs to keep
+const size_t drift_cache_limit = 64;
+
+drift_cache_t drift_cache;
+limits_cache_t limits_cache;
+bool limits_cache_loaded = false;
+
+/*!
+ * \brief Compute the exact drift pdf after transmitting 'T' symbols
  *
- *    p_j0 = Pt^T . Pi^m . Pf^j0 . C(T, j0) . C(T+m+j0-1, m+j0)
+ * At each channel use, a number k >= 0 of symbols is inserted (with
+ * probability Pi^k) before the transmitted symbol is either received
+ * (with probability Pt = 1 - Pi - Pd) or deleted (with probability Pd).
+ * The drift pdf after t+1 channel uses is therefore obtained from the one
+ * after t channel uses as:
  *
- * Now the binomial coefficients can be computed using the multiplicative
- * formula:
- *    C(n,k) = product for i=1..k of (n-k-i)/i
+ *    phi_{t+1}(m) = Pt A_t(m) + Pd A_t(m+1)
  *
- * Therefore the binomial coefficients in p_j0 are computed as:
+ * where A_t(m) = sum for k >= 0 of Pi^k phi_t(m-k)
+ *              = phi_t(m) + Pi A_t(m-1)
  *
- * C(T, j0) = product for i=1..j0 of (T-j0-i)/i
- * C(T+m+j0-1, m+j0) = product for i=1..m+j0 of (T-1-i)/i
+ * Starting from phi_0(0) = 1, this gives the complete pdf in a single pass
+ * over the support at each step. Probabilities that are too small to be
+ * represented in double precision are dropped at each step, which keeps
+ * the support to the useful range. This is equivalent to the explicit
+ * summation given in our submission to Transactions on Communications.
  */
-double qids_utils::compute_drift_prob_exact_0(int m, int T, double Pi, double Pd)
+boost::shared_ptr<const drift_table> compute_drift_table(int T, double Pi,
+      double Pd)
    {
-   assert(Pi > 0 && Pd > 0);
    typedef long double myreal;
-   // shortcut for out-of-range values
-   if (m < -T) // too many deletions required
-      return 0;
+   // negligible probability, well below the smallest double value
+   const myreal tiny = 1e-400L;
    // set constants
-   const double Pt = 1 - Pi - Pd;
-   const double Pf = Pi * Pd / Pt;
-   const int j0 = std::max(-m, 0);
-   // compute common factor (in log domain) for j=j0
-   myreal pj = 0;
-   // include first two terms in p_j0
-   pj += log(myreal(Pt)) * T;
-   pj += log(myreal(Pi)) * m;
-   // include third term in p_j0
-   if (j0 > 0)
-      pj += log(Pf) * j0;
-   // include first binomial coefficient term in p_j0
-   for (int i = 1; i <= j0; i++)
-      pj += log(myreal(T - j0 + i)) - log(myreal(i));
-   // include second binomial coefficient term in p_j0
-   for (int i = 1; i <= m + j0; i++)
-      pj += log(myreal(T - 1 + i)) - log(myreal(i));
-#if DEBUG>=3
-   std::cerr << "DEBUG (qids-utils): [pdf-exact] m = " << m << ", p_j0 = " << pj << std::endl;
-#endif
-   // main computation
-   myreal this_p = exp(pj);
-   for (int j = j0 + 1; j <= T; j++)
+   const myreal Pt = 1 - Pi - Pd;
+   // drift pdf phi_t(m) for lo <= m < lo + phi.size()
+   std::vector<myreal> phi(1, 1);
+   std::vector<myreal> next;
+   int lo = 0;
+   for (int t = 0; t < T; t++)
       {
-      // update factor
-      pj += log(Pf);
-      pj += log(myreal(T + m + j - 1)) - log(myreal(m + j));
-      pj += log(myreal(T - j + 1)) - log(myreal(j));
-      // update main result
-      this_p += exp(pj);
-#if DEBUG>=3
-      std::cerr << "DEBUG (qids-utils): [pdf-exact] j = " << j << ", p_j = " << pj << ", this_p = " << this_p << std::endl;
-#endif
+      const int n = int(phi.size());
+      // new support starts one lower if there are deletions
+      const int start = (Pd > 0) ? lo - 1 : lo;
+      next.clear();
+      // A_t(m) for m up to the last value in the support
+      myreal A = 0;
+      myreal A_next = 0;
+      for (int m = start; m < lo + n; m++)
+         {
+         // compute A_t(m) and A_t(m+1)
+         if (m == start)
+            {
+            A = (m >= lo) ? phi[m - lo] : 0;
+            }
+         else
+            A = A_next;
+         A_next = ((m + 1 < lo + n) ? phi[m + 1 - lo] : 0) + Pi * A;
+         next.push_back(Pt * A + Pd * A_next);
+         }
+      // extend the support while insertions give non-negligible values
+      if (Pi > 0)
+         {
+         for (;;)
+            {
+            A = A_next;
+            A_next = Pi * A;
+            const myreal p = Pt * A + Pd * A_next;
+            if (p < tiny)
+               break;
+            next.push_back(p);
+            }
+         }
+      // drop negligible values at either end
+      int first = 0;
+      while (first < int(next.size()) - 1 && next[first] < tiny)
+         first++;
+      int last = int(next.size());
+      while (last > first + 1 && next[last - 1] < tiny)
+         last--;
+      phi.assign(next.begin() + first, next.begin() + last);
+      lo = start + first;
       }
-   return this_p;
+   // convert the result
+   boost::shared_ptr<drift_table> table(new drift_table);
+   table->lo = lo;
+   table->p.assign(phi.begin(), phi.end());
+   return table;
    }
 
-/*! \copydoc qids_utils::compute_drift_prob_exact()
+/*!
+ * \brief Hash of the given start-of-frame pdf
  *
- * Degenerate case 1: Pi > 0, Pd = 0
- *    p_j is non-zero only for j=0, so that:
- *    Pr{ S_T = m } = Pt^T Pi^m C(T+m-1, m) for m >= 0,
- *                  = 0 otherwise
+ * This is the 64-bit FNV-1a hash of the value representation.
  */
-double qids_utils::compute_drift_prob_exact_1(int m, int T, double Pi, double Pd)
+libbase::int64u hash_pdf(const libbase::vector<double>& pdf)
    {
-   assert(Pi > 0 && Pd == 0);
-   typedef long double myreal;
-   // shortcut for out-of-range values
-   if (m < 0) // deletions required
-      return 0;
-   // set constants
-   const double Pt = 1 - Pi - Pd;
-   // compute result in log domain
-   myreal result = 0;
-   // include first two terms in result
-   result += log(myreal(Pt)) * T;
-   result += log(myreal(Pi)) * m;
-   // include binomial coefficient term in result
-   for (int i = 1; i <= m; i++)
-      result += log(myreal(T - 1 + i)) - log(myreal(i));
-   // convert factor back from log domain
-   return exp(result);
+   libbase::int64u h = 14695981039346656037ULL;
+   for (int i = 0; i < pdf.size(); i++)
+      {
+      const unsigned char* b = reinterpret_cast<const unsigned char*> (&pdf(i));
+      for (size_t k = 0; k < sizeof(double); k++)
+         {
+         h ^= b[k];
+         h *= 1099511628211ULL;
+         }
+      }
+   return h;
    }
 
-/*! \copydoc qids_utils::compute_drift_prob_exact()
- *
- * Degenerate case 2: Pd > 0, Pi = 0
- *    p_j is non-zero only for j=-m, so that:
- *    Pr{ S_T = m } = Pt^{T+m} Pd^-m C(T, -m) for m <= 0,
- *                  = 0 otherwise
- */
-double qids_utils::compute_drift_prob_exact_2(int m, int T, double Pi, double Pd)
+//! Name of the file keeping computed limits between runs, if any
+std::string limits_cache_file()
    {
-   assert(Pi == 0 && Pd > 0);
-   typedef long double myreal;
-   // shortcut for out-of-range values
-   if (m > 0) // insertions required
-      return 0;
-   else if (m < -T) // too many deletions required
-      return 0;
-   // set constants
-   const double Pt = 1 - Pi - Pd;
-   // compute result in log domain
-   myreal result = 0;
-   // include first two terms in result
-   result += log(myreal(Pt)) * (T + m);
-   result += log(myreal(Pd)) * (-m);
-   // include binomial coefficient term in result
-   for (int i = 1; i <= -m; i++)
-      result += log(myreal(T + m + i)) - log(myreal(i));
-   // convert factor back from log domain
-   return exp(result);
+   libbase::sysvar v("SIMCOMMSYS_QIDS_CACHE");
+   if (v.is_defined())
+      return v.as_string();
+   return "";
    }
 
-/*! \copydoc qids_utils::compute_drift_prob_exact()
- *
- * Degenerate case 3: Pi = Pd = 0
- *    p_j is non-zero only for j=0 and m=0, so that:
- *    Pr{ S_T = m } = 1 for m = 0,
- *                  = 0 otherwise
- */
-double qids_utils::compute_drift_prob_exact_3(int m, int T, double Pi, double Pd)
+//! Load limits kept by earlier runs
+void load_limits_cache()
    {
-   assert(Pi == 0 && Pd == 0);
-   return (m == 0) ? 1 : 0;
+   limits_cache_loaded = true;
+   const std::string fname = limits_cache_file();
+   if (fname.empty())
+      return;
+   std::ifstream file(fname.c_str());
+   limits_key k;
+   std::pair<int, int> r;
+   while (file >> k.kind >> k.T >> k.Pi >> k.Pd >> k.Pr >> k.offset
+         >> k.size >> k.hash >> r.first >> r.second)
+      limits_cache[k] = r;
    }
 
+//! Keep limits for later runs
+void save_limits_cache(const limits_key& k, const std::pair<int, int>& r)
+   {
+   const std::string fname = limits_cache_file();
+   if (fname.empty())
+      return;
+   std::ostringstream sout;
+   sout.precision(17);
+   sout << k.kind << ' ' << k.T << ' ' << k.Pi << ' ' << k.Pd << ' ' << k.Pr
+         << ' ' << k.offset << ' ' << k.size << ' ' << k.hash << ' '
+         << r.first << ' ' << r.second << std::endl;
+   std::ofstream file(fname.c_str(), std::ios_base::out | std::ios_base::app);
+   file << sout.str() << std::flush;
+   }
+
+} // end unnamed namespace
+
 /*!
  * \brief Computes the probability of drift 'm' after transmitting 'T' symbols
  * using the exact metric from our submission to Transactions on Communications.
+ *
+ * The complete pdf for the given parameters is computed on first use and
+ * kept in a process-wide cache.
  */
 double qids_utils::compute_drift_prob_exact(int m, int T, double Pi, double Pd)
    {
-   typedef long double myreal;
    // sanity checks
    assert(T > 0);
    validate(Pd, Pi);
 #if DEBUG>=3
    std::cerr << "DEBUG (qids-utils): compute_drift_prob_exact(" << m << "," << T << "," << Pi << "," << Pd << ")" << std::endl;
 #endif
-   // caching of results
-   static std::map<pair, double, compare_pairs> cache;
-   static double last_Pi = -1; // initialize to an invalid value
-   static double last_Pd = -1; // initialize to an invalid value
-   if (last_Pi != Pi || last_Pd != Pd)
+   // find the pdf for these parameters, computing it if necessary
+   boost::shared_ptr<const drift_table> table;
+   const drift_key key = {T, Pi, Pd};
+#pragma omp critical(qids_utils_cache)
       {
-      last_Pi = Pi;
-      last_Pd = Pd;
-      cache.clear();
+      drift_cache_t::const_iterator it = drift_cache.find(key);
+      if (it != drift_cache.end())
+         table = it->second;
+      else
+         {
+         if (drift_cache.size() >= drift_cache_limit)
+            drift_cache.clear();
+         table = compute_drift_table(T, Pi, Pd);
+         drift_cache[key] = table;
+         }
       }
-   // see if we have this value already in cache
-   const pair key(m,T);
-   std::map<pair, double, compare_pairs>::const_iterator it = cache.find(key);
-   // return it if we do
-   if (it != cache.end())
-      return it->second;
-   // space for result
-   myreal this_p;
-   // handle non-degenerate case: Pi > 0, Pd > 0
-   if (Pi > 0 && Pd > 0)
-      this_p = compute_drift_prob_exact_0(m, T, Pi, Pd);
-   // handle degenerate case 1: Pi > 0, Pd = 0
-   else if (Pi > 0)
-      this_p = compute_drift_prob_exact_1(m, T, Pi, Pd);
-   // handle degenerate case 2: Pd > 0, Pi = 0
-   else if (Pd > 0)
-      this_p = compute_drift_prob_exact_2(m, T, Pi, Pd);
-   // handle degenerate case 3: Pi = Pd = 0
-   else
-      this_p = compute_drift_prob_exact_3(m, T, Pi, Pd);
+   // look up the requested value
+   const int i = m - table->lo;
+   if (i < 0 || i >= int(table->p.size()))
+      return 0;
+   const double this_p = table->p[i];
 #if DEBUG>=3
    std::cerr << "DEBUG (qids-utils): [pdf-exact] this_p = " << this_p << std::endl;
 #endif
@@ -283,8 +338,6 @@ double qids_utils::compute_drift_prob_exact(int m, int T, double Pi, double Pd)
       throw std::overflow_error("value not finite");
    else if (this_p < 0)
       throw std::overflow_error("negative value");
-   // store this value in cache
-   cache[key] = this_p;
    return this_p;
    }
 
@@ -347,4 +400,87 @@ int qids_utils::compute_xmax_davey(int T, double Pi, double Pd, double Pr)
    return xmax;
    }
 
+/*!
+ * \brief Determine a state space limit, through the results cache
+ *
+ * For kind 0, this computes upper and lower drift limits; for kind 1, it
+ * computes the maximum absolute drift, returned as the upper limit.
+ */
+void qids_utils::cached_limits(int kind, int T, double Pi, double Pd,
+      double Pr, const libbase::vector<double>& sof_pdf, const int offset,
+      int& lower, int& upper)
+   {
+   limits_key key;
+   key.kind = kind;
+   key.T = T;
+   key.Pi = Pi;
+   key.Pd = Pd;
+   key.Pr = Pr;
+   key.offset = offset;
+   key.size = sof_pdf.size();
+   key.hash = hash_pdf(sof_pdf);
+   // see if we have this result already
+   bool found = false;
+   std::pair<int, int> result;
+#pragma omp critical(qids_utils_cache)
+      {
+      if (!limits_cache_loaded)
+         load_limits_cache();
+      limits_cache_t::const_iterator it = limits_cache.find(key);
+      if (it != limits_cache.end())
+         {
+         result = it->second;
+         found = true;
+         }
+      }
+   // compute it if we don't
+   if (!found)
+      {
+      compute_drift_prob_functor f(compute_drift_prob_exact, sof_pdf, offset);
+      if (kind == 0)
+         compute_limits_with(f, T, Pi, Pd, Pr, result.first, result.second);
+      else
+         {
+         result.second = compute_xmax_with(f, T, Pi, Pd, Pr);
+         result.first = -result.second;
+         }
+#pragma omp critical(qids_utils_cache)
+         {
+         limits_cache[key] = result;
+         save_limits_cache(key, result);
+         }
+      }
+   lower = result.first;
+   upper = result.second;
+   }
+
+/*!
+ * \brief Determine maximum drift at the end of a frame of 'T' symbols, given
+ * the supplied drift pdf at start of transmission.
+ */
+int qids_utils::compute_xmax(int T, double Pi, double Pd, double Pr,
+      const libbase::vector<double>& sof_pdf, const int offset)
+   {
+   int lower, xmax;
+   cached_limits(1, T, Pi, Pd, Pr, sof_pdf, offset, lower, xmax);
+#if DEBUG>=3
+   std::cerr << "DEBUG (qids): [exact] for T = " << T << ", xmax = " << xmax << "." << std::endl;
+#endif
+   return xmax;
+   }
+
+/*!
+ * \brief Determine upper and lower drift limits at the end of a frame of
+ * 'T' symbols, given the supplied drift pdf at start of transmission.
+ */
+void qids_utils::compute_limits(int T, double Pi, double Pd, double Pr,
+      int& mT_min, int& mT_max, const libbase::vector<double>& sof_pdf,
+      const int offset)
+   {
+   cached_limits(0, T, Pi, Pd, Pr, sof_pdf, offset, mT_min, mT_max);
+#if DEBUG>=3
+   std::cerr << "DEBUG (qids): [exact] for T = " << T << ", mT_min = " << mT_min << ", mT_max = " << mT_max << "." << std::endl;
+#endif
+   }
+
 } // end namespace
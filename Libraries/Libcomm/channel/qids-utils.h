@@ -48,6 +48,11 @@ namespace libcomm {
  * error channel (qids). It implements (as static methods) a number of
  * functions for the computation of the channel drift distribution and the
  * dependent state space limits.
+ *
+ * The exact drift pdf and the state space limits depend only on their
+ * parameters, so they are kept in a process-wide cache that may be shared
+ * by all threads. If the environment variable SIMCOMMSYS_QIDS_CACHE is set,
+ * it names a file where computed limits are also kept between runs.
  */
 
 class qids_utils {
@@ -72,35 +77,12 @@ private:
          return compute_drift_prob_with(func, m, T, Pi, Pd, sof_pdf, offset);
          }
    };
-   /*! \brief A class representing a pair of integers.
-    * Used to represent the key value in a std::map used to cache results of
-    * compute_drift_prob_exact.
-    */
-   class pair {
-   public:
-      int a;
-      int b;
-   public:
-      pair(const int& a, const int& b) :
-            a(a), b(b)
-         {
-         }
-   };
-   /*! \brief Functor for comparing pairs.
-    * \note This makes use of short-circuit evaluation
-    */
-   struct compare_pairs {
-      bool operator()(const pair& lhs, const pair& rhs) const
-         {
-         return lhs.a < rhs.a || (lhs.a == rhs.a && lhs.b < rhs.b);
-         }
-   };
    // @}
    /*! \name Internal function definitions */
-   static double compute_drift_prob_exact_0(int m, int T, double Pi, double Pd);
-   static double compute_drift_prob_exact_1(int m, int T, double Pi, double Pd);
-   static double compute_drift_prob_exact_2(int m, int T, double Pi, double Pd);
-   static double compute_drift_prob_exact_3(int m, int T, double Pi, double Pd);
+   //! Determine a state space limit, through the results cache
+   static void cached_limits(int kind, int T, double Pi, double Pd,
+         double Pr, const libbase::vector<double>& sof_pdf, const int offset,
+         int& lower, int& upper);
    // @}
 public:
    /*! \name Channel drift computation */
@@ -289,15 +271,7 @@ public:
     */
    static int compute_xmax(int T, double Pi, double Pd, double Pr,
          const libbase::vector<double>& sof_pdf = libbase::vector<double>(),
-         const int offset = 0)
-      {
-      compute_drift_prob_functor f(compute_drift_prob_exact, sof_pdf, offset);
-      const int xmax = compute_xmax_with(f, T, Pi, Pd, Pr);
-#if DEBUG>=3
-      std::cerr << "DEBUG (qids): [exact] for T = " << T << ", xmax = " << xmax << "." << std::endl;
-#endif
-      return xmax;
-      }
+         const int offset = 0);
    /*!
     * \brief Determine upper and lower drift limits at the end of a frame of
     * 'T' symbols, given the supplied drift pdf at start of transmission.
@@ -305,14 +279,7 @@ public:
    static void compute_limits(int T, double Pi, double Pd, double Pr,
          int& mT_min, int& mT_max,
          const libbase::vector<double>& sof_pdf = libbase::vector<double>(),
-         const int offset = 0)
-      {
-      compute_drift_prob_functor f(compute_drift_prob_exact, sof_pdf, offset);
-      compute_limits_with(f, T, Pi, Pd, Pr, mT_min, mT_max);
-#if DEBUG>=3
-      std::cerr << "DEBUG (qids): [exact] for T = " << T << ", mT_min = " << mT_min << ", mT_max = " << mT_max << "." << std::endl;
-#endif
-      }
+         const int offset = 0);
    // @}
 
    /*! \name General utility functions */
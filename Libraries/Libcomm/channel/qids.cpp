@@ -372,6 +372,190 @@ void qids<G, real>::metric_computer::receive_lattice_corridor(
       }
    }
 
+/*!
+ * \brief Batch receiver interface - set of transmitted sequences
+ *
+ * The rows of the forward computation (trellis or lattice) up to row 'i'
+ * depend only on the first 'i' transmitted symbols. Therefore, rows computed
+ * for one sequence are kept, and for the next sequence only the rows after
+ * the prefix common to both are recomputed. When the sequences are given in
+ * lexicographic order, this amounts to a depth-first traversal of the trie
+ * of transmitted sequences, with each trie node computed once.
+ *
+ * The computation for each row is the same as in the corresponding
+ * single-sequence receiver, so that results are identical.
+ *
+ * \note All transmitted sequences must have the same length.
+ */
+template <class G, class real>
+void qids<G, real>::metric_computer::receive(const array1vg_t& tx,
+      const array1g_t& rx, array1vr_t& ptable) const
+   {
+   // Compute sizes
+   const int q = tx.size();
+   assert(ptable.size() == q);
+   if (q == 0)
+      return;
+   const int n = tx(0).size();
+   const int rho = rx.size();
+   assert(n >= 1);
+   // Set up a row of the forward computation for each prefix length
+   // (trellis rows are indexed by drift, offset so that mT_min is at zero)
+   const bool trellis = (receiver_type == receiver_trellis);
+   array1vr_t F(n + 1);
+   for (int i = 0; i <= n; i++)
+      {
+      F(i).init(trellis ? mT_max - mT_min + 1 : rho + 1);
+      F(i) = 0;
+      }
+   // initialize for the empty prefix
+   switch (receiver_type)
+      {
+      case receiver_trellis:
+         // we know x[0] = 0; ie. drift before transmitting symbol t0 is zero.
+         F(0)(-mT_min) = 1;
+         break;
+      case receiver_lattice:
+         F(0)(0) = 1;
+         for (int j = 1; j <= rho; j++)
+            F(0)(j) = F(0)(j - 1) * Pval_i;
+         break;
+      case receiver_lattice_corridor:
+         F(0)(0) = 1;
+         for (int j = 1; j <= std::min(mT_max, rho); j++)
+            F(0)(j) = F(0)(j - 1) * Pval_i;
+         break;
+      default:
+         failwith("Unknown receiver mode");
+         break;
+      }
+   // consider each transmitted sequence in turn
+   for (int d = 0; d < q; d++)
+      {
+      assert(tx(d).size() == n);
+      // determine length of prefix in common with previous sequence
+      int prefix = 0;
+      if (d > 0)
+         while (prefix < n && tx(d)(prefix) == tx(d - 1)(prefix))
+            prefix++;
+      // compute rows that depend on the remaining symbols
+      for (int i = prefix + 1; i <= n; i++)
+         {
+         const G s = tx(d)(i - 1);
+         const array1r_t& Fprev = F(i - 1);
+         array1r_t& Fthis = F(i);
+         switch (receiver_type)
+            {
+            case receiver_trellis:
+               {
+               // for this list, reset all elements to zero
+               Fthis = 0;
+               const int ymin = std::max(mT_min, -i);
+               const int ymax = std::min(mT_max, rho - i);
+               for (int y = ymin; y <= ymax; ++y)
+                  {
+                  real result = 0;
+                  const int amin = std::max(std::max(mT_min, 1 - i), y - m1_max);
+                  const int amax = std::min(mT_max, y - m1_min);
+                  // check if the last element is a pure deletion
+                  int amax_act = amax;
+                  if (y - amax < 0)
+                     {
+                     result += Fprev(amax - mT_min) * Rval;
+                     amax_act--;
+                     }
+                  // elements requiring comparison of tx and rx symbols
+                  for (int a = amin; a <= amax_act; ++a)
+                     {
+                     const bool cmp = s != rx(i + y - 1);
+                     result += Fprev(a - mT_min) * Rtable(cmp, y - a);
+                     }
+                  Fthis(y - mT_min) = result;
+                  }
+               }
+               break;
+            case receiver_lattice:
+               {
+               // handle first column as a special case
+               real temp = Fprev(0);
+               temp *= Pval_d;
+               Fthis(0) = temp;
+               // remaining columns (no insertions on last row)
+               for (int j = 1; j <= rho; j++)
+                  {
+                  const real pd = Fprev(j) * Pval_d;
+                  const bool cmp = s == rx(j - 1);
+                  const real ps = Fprev(j - 1) * (cmp ? Pval_tc : Pval_te);
+                  real temp = ps + pd;
+                  if (i < n)
+                     temp += Fthis(j - 1) * Pval_i;
+                  Fthis(j) = temp;
+                  }
+               }
+               break;
+            case receiver_lattice_corridor:
+               {
+               // start from previous row, as the corridor is updated in place
+               Fthis = Fprev;
+               // keep Fprev[0]
+               real Fp = Fthis(0);
+               // handle first column as a special case, if necessary
+               if (i + mT_min <= 0)
+                  Fthis(0) = Fp * Pval_d;
+               // determine limits for remaining columns (after first)
+               // the last row is a special case (no insertions, all columns)
+               int jmin = 1;
+               int jmax = rho;
+               if (i < n)
+                  {
+                  jmin = std::max(i + mT_min, 1);
+                  jmax = std::min(i + mT_max, rho);
+                  // keep Fprev[jmin - 1], if necessary
+                  if (jmin > 1)
+                     Fp = Fthis(jmin - 1);
+                  }
+               // remaining columns
+               for (int j = jmin; j <= jmax; j++)
+                  {
+                  // transmission/substitution path
+                  const bool cmp = s == rx(j - 1);
+                  real temp = Fp * (cmp ? Pval_tc : Pval_te);
+                  // keep Fprev[j] for next time (to use as Fprev[j-1])
+                  Fp = Fthis(j);
+                  // deletion path (if previous row was within corridor)
+                  if (j < i + mT_max)
+                     temp += Fp * Pval_d;
+                  // insertion path
+                  if (i < n)
+                     temp += Fthis(j - 1) * Pval_i;
+                  Fthis(j) = temp;
+                  }
+               }
+               break;
+            default:
+               failwith("Unknown receiver mode");
+               break;
+            }
+         }
+      // copy results
+      assertalways(ptable(d).size() == mT_max - mT_min + 1);
+      for (int x = mT_min; x <= mT_max; x++)
+         {
+         if (trellis)
+            ptable(d)(x - mT_min) = F(n)(x - mT_min);
+         else
+            {
+            // convert index
+            const int j = x + n;
+            if (j >= 0 && j <= rho)
+               ptable(d)(x - mT_min) = F(n)(j);
+            else
+               ptable(d)(x - mT_min) = 0;
+            }
+         }
+      }
+   }
+
 #endif
 
 /*!
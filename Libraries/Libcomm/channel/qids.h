@@ -66,6 +66,8 @@ public:
    typedef libbase::vector<int> array1i_t;
    typedef libbase::vector<bool> array1b_t;
    typedef libbase::vector<G> array1g_t;
+   typedef libbase::vector<array1g_t> array1vg_t;
+   typedef libbase::vector<array1r_t> array1vr_t;
    typedef libbase::vector<double> array1d_t;
    typedef libbase::vector<array1d_t> array1vd_t;
    enum receiver_t {
@@ -503,6 +505,11 @@ public:
       //! Batch receiver interface - lattice computation, restricted to corridor
       void receive_lattice_corridor(const array1g_t& tx, const array1g_t& rx,
             array1r_t& ptable) const;
+#ifndef USE_CUDA
+      //! Batch receiver interface - set of transmitted sequences
+      void receive(const array1vg_t& tx, const array1g_t& rx,
+            array1vr_t& ptable) const;
+#endif
       //! Batch receiver interface - fixed state space
       void receive(const array1g_t& tx, const array1g_t& rx, const int S0,
             const int delta0, const bool first, const bool last,
@@ -45,6 +45,8 @@ public:
    typedef libbase::vector<real> array1r_t;
    typedef libbase::vector<int> array1i_t;
    typedef libbase::vector<S> array1s_t;
+   typedef libbase::vector<array1r_t> array1vr_t;
+   typedef libbase::vector<array1s_t> array1vs_t;
    // @}
 public:
    /*! \name Metric computation */
@@ -73,6 +75,19 @@ public:
       //! Batch receiver interface - indefinite state space
       virtual void receive(const array1s_t& tx, const array1s_t& rx,
             array1r_t& ptable) const = 0;
+      /*! \brief Batch receiver interface - set of transmitted sequences
+       * Computes the batch receiver result for each of the given transmitted
+       * sequences against the same received sequence, placing the result for
+       * tx(d) in ptable(d); the result vectors must be set up by the caller.
+       * The default implementation simply considers each sequence in turn.
+       */
+      virtual void receive(const array1vs_t& tx, const array1s_t& rx,
+            array1vr_t& ptable) const
+         {
+         assert(ptable.size() == tx.size());
+         for (int d = 0; d < tx.size(); d++)
+            receive(tx(d), rx, ptable(d));
+         }
       //! Batch receiver interface - fixed state space
       virtual void receive(const array1s_t& tx, const array1s_t& rx,
             const int S0, const int delta0, const bool first, const bool last,
@@ -22,9 +22,84 @@
 #include "codec_multiblock.h"
 #include "vectorutils.h"
 #include <sstream>
+#include <algorithm>
+
+#ifdef USE_OMP
+#  include <omp.h>
+#endif
 
 namespace libcomm {
 
+// internal operations
+
+/*!
+ * \brief Set up copies of codec object for decoding
+ *
+ * One copy is made for every thread that may be used to decode blocks
+ * concurrently (but no more than the number of blocks). Without OpenMP
+ * support, only the original codec object is used.
+ */
+template <template <class > class C, class dbl>
+void codec_multiblock<C, dbl>::init_decoders()
+   {
+#ifdef USE_OMP
+   const int n = std::max(1, std::min(N, omp_get_max_threads()));
+#else
+   const int n = 1;
+#endif
+   cdc_dec.init(n);
+   cdc_dec(0) = cdc;
+   for (int t = 1; t < n; t++)
+      cdc_dec(t) = boost::dynamic_pointer_cast<codec_softout<C, dbl> >(
+            cdc->clone());
+   }
+
+/*!
+ * \brief Decode a single block
+ * \param[in]  i            Index of block to decode
+ * \param[in]  soft_output  Flag indicating output-referred statistics needed
+ * \param[out] ri           Likelihood table for input symbols (whole frame)
+ * \param[out] ro           Likelihood table for output symbols (whole frame)
+ *
+ * Output tables must be already allocated; only the segment corresponding
+ * to the given block is written. The codec copy used is the one for the
+ * calling thread, so that different blocks may be decoded concurrently.
+ */
+template <template <class > class C, class dbl>
+void codec_multiblock<C, dbl>::decode_block(int i, bool soft_output,
+      C<array1d_t>& ri, C<array1d_t>& ro)
+   {
+#ifdef USE_OMP
+   codec_softout<C, dbl>& c = *cdc_dec(omp_get_thread_num());
+#else
+   codec_softout<C, dbl>& c = *cdc_dec(0);
+#endif
+   // Initialize the codec
+   libbase::indirect_vector<array1d_t> ptable_segment = ptable.extract(
+         c.output_block_size() * i, c.output_block_size());
+   if (app.size() > 0)
+      {
+      libbase::indirect_vector<array1d_t> app_segment = app.extract(
+            c.input_block_size() * i, c.input_block_size());
+      c.init_decoder(ptable_segment, app_segment);
+      }
+   else
+      c.init_decoder(ptable_segment);
+   // Perform soft-output decoding for as many iterations as needed
+   libbase::indirect_vector<array1d_t> ri_segment = ri.segment(
+         c.input_block_size() * i, c.input_block_size());
+   if (soft_output)
+      {
+      libbase::indirect_vector<array1d_t> ro_segment = ro.segment(
+            c.output_block_size() * i, c.output_block_size());
+      for (int j = 0; j < c.num_iter(); j++)
+         c.softdecode(ri_segment, ro_segment);
+      }
+   else
+      for (int j = 0; j < c.num_iter(); j++)
+         c.softdecode(ri_segment);
+   }
+
 // encode / decode methods
 
 template <template <class > class C, class dbl>
@@ -51,28 +126,13 @@ void codec_multiblock<C, dbl>::softdecode(C<array1d_t>& ri)
    test_invariant();
    // allocate output vector
    libbase::allocate(ri, this->input_block_size(), this->num_inputs());
-   // iterate over all blocks in sequence
+   // decode all blocks (concurrently, if possible)
+   C<array1d_t> ro;
+#ifdef USE_OMP
+#pragma omp parallel for num_threads(cdc_dec.size()) schedule(dynamic)
+#endif
    for (int i = 0; i < N; i++)
-      {
-      // Initialize the codec
-      libbase::indirect_vector<array1d_t> ptable_segment = ptable.extract(
-            cdc->output_block_size() * i, cdc->output_block_size());
-      if (app.size() > 0)
-         {
-         libbase::indirect_vector<array1d_t> app_segment = app.extract(
-               cdc->input_block_size() * i, cdc->input_block_size());
-         cdc->init_decoder(ptable_segment, app_segment);
-         }
-      else
-         cdc->init_decoder(ptable_segment);
-      // Perform soft-output decoding for as many iterations as needed
-      for (int j = 0; j < cdc->num_iter(); j++)
-         {
-         libbase::indirect_vector<array1d_t> ri_segment = ri.segment(
-               cdc->input_block_size() * i, cdc->input_block_size());
-         cdc->softdecode(ri_segment);
-         }
-      }
+      decode_block(i, false, ri, ro);
    test_invariant();
    }
 
@@ -83,30 +143,12 @@ void codec_multiblock<C, dbl>::softdecode(C<array1d_t>& ri, C<array1d_t>& ro)
    // allocate output vectors
    libbase::allocate(ri, this->input_block_size(), this->num_inputs());
    libbase::allocate(ro, this->output_block_size(), this->num_outputs());
-   // iterate over all blocks in sequence
+   // decode all blocks (concurrently, if possible)
+#ifdef USE_OMP
+#pragma omp parallel for num_threads(cdc_dec.size()) schedule(dynamic)
+#endif
    for (int i = 0; i < N; i++)
-      {
-      // Initialize the codec
-      libbase::indirect_vector<array1d_t> ptable_segment = ptable.extract(
-            cdc->output_block_size() * i, cdc->output_block_size());
-      if (app.size() > 0)
-         {
-         libbase::indirect_vector<array1d_t> app_segment = app.extract(
-               cdc->input_block_size() * i, cdc->input_block_size());
-         cdc->init_decoder(ptable_segment, app_segment);
-         }
-      else
-         cdc->init_decoder(ptable_segment);
-      // Perform soft-output decoding for as many iterations as needed
-      for (int j = 0; j < cdc->num_iter(); j++)
-         {
-         libbase::indirect_vector<array1d_t> ri_segment = ri.segment(
-               cdc->input_block_size() * i, cdc->input_block_size());
-         libbase::indirect_vector<array1d_t> ro_segment = ro.segment(
-               cdc->output_block_size() * i, cdc->output_block_size());
-         cdc->softdecode(ri_segment, ro_segment);
-         }
-      }
+      decode_block(i, true, ri, ro);
    test_invariant();
    }
 
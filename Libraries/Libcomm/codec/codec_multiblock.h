@@ -41,6 +41,10 @@ namespace libcomm {
 /*!
  * \brief   Channel Codec aggregating multiple blocks of underlying codec.
  * \author  Johann Briffa
+ *
+ * Since blocks are independent, decoding is performed concurrently when
+ * OpenMP support is compiled in. Each thread uses its own copy of the
+ * underlying codec, made (after seeding) from the original object.
  */
 
 template <template <class > class C = libbase::vector, class dbl = double>
@@ -56,6 +60,7 @@ private:
    // @}
    /*! \name Internally-used objects */
    boost::shared_ptr<codec_softout<C, dbl> > cdc_enc; //!< Copy of codec object for encoder operations
+   libbase::vector<boost::shared_ptr<codec_softout<C, dbl> > > cdc_dec; //!< Copies of codec object for decoding blocks concurrently
    C<array1d_t> ptable; //!< Copy of channel probabilities, to be segmented and used
    C<array1d_t> app; //!< Copy of prior probabilities, to be segmented and used
    // @}
@@ -68,6 +73,9 @@ protected:
       assert(cdc);
       assert(N >= 1);
       }
+   void init_decoders();
+   void decode_block(int i, bool soft_output, C<array1d_t>& ri,
+         C<array1d_t>& ro);
    // @}
    // Interface with derived classes
    void do_encode(const C<int>& source, C<int>& encoded);
@@ -92,6 +100,8 @@ public:
       cdc->seedfrom(r);
       // Make a copy of codec object for encoder operations
       cdc_enc = boost::dynamic_pointer_cast<codec_softout<C, dbl> >(cdc->clone());
+      // Make copies of codec object for decoder operations
+      init_decoders();
       }
    void softdecode(C<array1d_t>& ri);
    void softdecode(C<array1d_t>& ri, C<array1d_t>& ro);
@@ -33,6 +33,9 @@
 #include <cmath>
 #include <sstream>
 #include <cstdlib>
+#include <algorithm>
+#include <set>
+#include <vector>
 
 namespace libcomm {
 
@@ -147,45 +150,246 @@ template <class GF_q, class real> ldpc<GF_q, real>::ldpc(
 
 template <class GF_q, class real> void ldpc<GF_q, real>::init()
    {
+   if (this->reduce_to_ref == false)
+      {
+      //encode directly from the sparse parity check matrix; this also
+      //determines the info symbol positions and the dimension of the code
+      this->init_sparse_encoder();
+      return;
+      }
 
    //compute the generator matrix for the code
-
    libbase::linear_code_utils<GF_q>::compute_dual_code(this->pchk_matrix,
          this->gen_matrix, this->perm_to_systematic);
 
    this->dim_k = this->gen_matrix.size().rows();
    this->info_symb_pos.init(this->dim_k);
 
-   if (this->reduce_to_ref == false)
+   //we reduce the generator matrix to REF format in the hope that the info symbols will be
+   //in the first k positions and that we'll therefore have a systematic code
+   this->gen_matrix = this->gen_matrix.reduce_to_ref();
+   //we now need to find the pivots
+   int posy = 0;
+   for (int loop = 0; loop < this->dim_k; loop++)
       {
-      //as we define the LDPC code by its parity check matrix,H , the generator matrix
-      //will be of the form (P|I) provided H was in systematic form when reduced to REF
-      //if H wasn't then perm_to_systematic contains the permutation that transformed
-      //H into systematic form which gives us the information we need to extract the
-      //positions of the info symbols in G. In fact the last k values of perm_to_systematic
-      //are those positions.
-      for (int loop = 0; loop < this->dim_k; loop++)
+      while (this->gen_matrix(loop, posy) == GF_q(0))
          {
-         this ->info_symb_pos(loop) = this->perm_to_systematic((this->length_n
-               - this->dim_k) + loop);
+         posy++;
          }
+      this->info_symb_pos(loop) = posy;
       }
-   else
+   }
+
+/*!
+ * The parity check matrix is triangulated greedily, in the manner of
+ * Richardson & Urbanke's approximate lower triangulation: whenever an unused
+ * row has a single unknown symbol, that symbol is solved for using that row.
+ * When no such row exists, one unknown symbol from the row with fewest
+ * unknowns is declared known (free). At the end, the rows not used for
+ * back-substitution are reduced to constraints on the free symbols only; a
+ * maximal independent set of these constraints determines the gap symbols,
+ * and the remaining free symbols are the information symbols.
+ *
+ * For typical LDPC codes both the number of free symbols beyond k and the
+ * number of unused rows are a small fraction of n, so that this setup avoids
+ * the cubic cost of computing the generator matrix.
+ */
+template <class GF_q, class real> void ldpc<GF_q, real>::init_sparse_encoder()
+   {
+   const int n = this->length_n;
+   const int m = this->dim_pchk;
+
+   // residual number of unknown symbols per row
+   array1i_t row_deg = this->row_weight;
+   array1i_t row_used(m);
+   row_used = 0;
+   // symbol state: 0 = unknown, 1 = solved by back-substitution, 2 = free
+   array1i_t col_state(n);
+   col_state = 0;
+   // rows with a single unknown symbol, and rows with more than one
+   std::vector<int> ready;
+   std::set<std::pair<int, int> > pending;
+   for (int row = 0; row < m; row++)
+      {
+      if (row_deg(row) == 1)
+         ready.push_back(row);
+      else if (row_deg(row) > 1)
+         pending.insert(std::make_pair(row_deg(row), row));
+      }
+
+   // triangulation
+   std::vector<int> rows, cols, free_cols;
+   int next_col = 0;
+   for (int resolved = 0; resolved < n; resolved++)
+      {
+      int col = -1;
+      while (col < 0 && !ready.empty())
+         {
+         const int row = ready.back();
+         ready.pop_back();
+         if (row_used(row) || row_deg(row) != 1)
+            continue;
+         for (int i = 0; col < 0; i++)
+            if (col_state(this->N_m(row)(i) - 1) == 0)
+               col = this->N_m(row)(i) - 1;
+         row_used(row) = 1;
+         col_state(col) = 1;
+         rows.push_back(row);
+         cols.push_back(col);
+         }
+      if (col < 0)
+         {
+         if (!pending.empty())
+            {
+            const int row = pending.begin()->second;
+            for (int i = 0; col < 0; i++)
+               if (col_state(this->N_m(row)(i) - 1) == 0)
+                  col = this->N_m(row)(i) - 1;
+            }
+         else
+            {
+            while (col_state(next_col) != 0)
+               next_col++;
+            col = next_col;
+            }
+         col_state(col) = 2;
+         free_cols.push_back(col);
+         }
+      // update the residual degree of the remaining rows
+      for (int i = 0; i < this->M_n(col).size(); i++)
+         {
+         const int row = this->M_n(col)(i) - 1;
+         if (row_used(row))
+            continue;
+         if (row_deg(row) > 1)
+            pending.erase(std::make_pair(row_deg(row), row));
+         row_deg(row)--;
+         if (row_deg(row) > 1)
+            pending.insert(std::make_pair(row_deg(row), row));
+         else if (row_deg(row) == 1)
+            ready.push_back(row);
+         }
+      }
+   this->enc_rows.init(int(rows.size()));
+   this->enc_cols.init(int(cols.size()));
+   for (int s = 0; s < this->enc_rows.size(); s++)
+      {
+      this->enc_rows(s) = rows[s];
+      this->enc_cols(s) = cols[s];
+      }
+
+   // reduce each unused row to a constraint on free symbols only, and
+   // keep a maximal independent set of these in reduced form
+   std::vector<int> left;
+   for (int row = 0; row < m; row++)
+      if (!row_used(row))
+         left.push_back(row);
+   const int nl = int(left.size());
+   const int nf = int(free_cols.size());
+   libbase::matrix<GF_q> basis; // reduced constraints
+   libbase::matrix<GF_q> transform; // in terms of unused rows
+   // note: matrices cannot have only one dimension empty
+   if (nl > 0 && nf > 0)
+      {
+      basis.init(nl, nf);
+      transform.init(nl, nl);
+      }
+   std::vector<int> pivots; // index into free_cols
+   std::vector<int> basis_rows; // index into left
+   libbase::vector<GF_q> w(n);
+   libbase::vector<GF_q> t(nl);
+   for (int l = 0; l < nl; l++)
       {
-      //we reduce the generator matrix to REF format in the hope that the info symbols will be
-      //in the first k positions and that we'll therefore have a systematic code
-      this->gen_matrix = this->gen_matrix.reduce_to_ref();
-      //we now need to find the pivots
-      int posy = 0;
-      for (int loop = 0; loop < this->dim_k; loop++)
+      const int row = left[l];
+      w = GF_q(0);
+      for (int i = 0; i < this->N_m(row).size(); i++)
          {
-         while (this->gen_matrix(loop, posy) == GF_q(0))
+         const int j = this->N_m(row)(i) - 1;
+         w(j) = this->pchk_matrix(row, j);
+         }
+      // eliminate solved symbols, in reverse encoding order
+      for (int s = this->enc_rows.size() - 1; s >= 0; s--)
+         {
+         const int c = this->enc_cols(s);
+         if (w(c) == GF_q(0))
+            continue;
+         const int r = this->enc_rows(s);
+         const GF_q factor = w(c) / this->pchk_matrix(r, c);
+         for (int i = 0; i < this->N_m(r).size(); i++)
             {
-            posy++;
+            const int j = this->N_m(r)(i) - 1;
+            w(j) -= factor * this->pchk_matrix(r, j);
             }
-         this->info_symb_pos(loop) = posy;
          }
+      // reduce against the current basis
+      t = GF_q(0);
+      t(l) = GF_q(1);
+      for (int b = 0; b < int(pivots.size()); b++)
+         {
+         const GF_q factor = w(free_cols[pivots[b]]);
+         if (factor == GF_q(0))
+            continue;
+         for (int f = 0; f < nf; f++)
+            w(free_cols[f]) -= factor * basis(b, f);
+         for (int i = 0; i < nl; i++)
+            t(i) -= factor * transform(b, i);
+         }
+      // add to basis if independent
+      int pivot = -1;
+      for (int f = 0; pivot < 0 && f < nf; f++)
+         if (w(free_cols[f]) != GF_q(0))
+            pivot = f;
+      if (pivot < 0)
+         continue;
+      const GF_q scale = GF_q(1) / w(free_cols[pivot]);
+      const int b = int(pivots.size());
+      for (int f = 0; f < nf; f++)
+         basis(b, f) = w(free_cols[f]) * scale;
+      for (int i = 0; i < nl; i++)
+         transform(b, i) = t(i) * scale;
+      pivots.push_back(pivot);
+      basis_rows.push_back(l);
       }
+
+   // set up the gap system
+   const int ng = int(pivots.size());
+   this->gap_cols.init(ng);
+   this->gap_rows.init(nl);
+   this->gap_transform.init(ng, ng > 0 ? nl : 0);
+   this->gap_system.init(ng, ng);
+   for (int l = 0; l < nl; l++)
+      this->gap_rows(l) = left[l];
+   for (int b = 0; b < ng; b++)
+      {
+      this->gap_cols(b) = free_cols[pivots[b]];
+      for (int i = 0; i < nl; i++)
+         this->gap_transform(b, i) = transform(b, i);
+      for (int c = 0; c < ng; c++)
+         this->gap_system(b, c) = basis(b, pivots[c]);
+      }
+
+   // the remaining free symbols are the info symbols
+   libbase::vector<bool> is_gap(nf);
+   is_gap = false;
+   for (int b = 0; b < ng; b++)
+      is_gap(pivots[b]) = true;
+   this->dim_k = nf - ng;
+   this->info_symb_pos.init(this->dim_k);
+   std::vector<int> info;
+   for (int f = 0; f < nf; f++)
+      if (!is_gap(f))
+         info.push_back(free_cols[f]);
+   std::sort(info.begin(), info.end());
+   for (int i = 0; i < this->dim_k; i++)
+      this->info_symb_pos(i) = info[i];
+   // the generator matrix is not used
+   this->gen_matrix.init(0, 0);
+
+#if DEBUG>=2
+   libbase::trace << "DEBUG (ldpc): sparse encoder with " << this->enc_rows.size()
+         << " back-substitution symbols, " << ng << " gap symbols, "
+         << nl - ng << " redundant checks" << std::endl;
+#endif
    }
 
 template <class GF_q, class real> void ldpc<GF_q, real>::do_init_decoder(
@@ -286,8 +490,11 @@ template <class GF_q, class real> void ldpc<GF_q, real>::isCodeword()
 template <class GF_q, class real> void ldpc<GF_q, real>::do_encode(
       const libbase::vector<int>& source, libbase::vector<int>& encoded)
    {
-   libbase::linear_code_utils<GF_q>::encode_cw(this->gen_matrix, source,
-         encoded);
+   if (this->reduce_to_ref)
+      libbase::linear_code_utils<GF_q>::encode_cw(this->gen_matrix, source,
+            encoded);
+   else
+      this->sparse_encode(source, encoded);
 
 #if DEBUG>=2
    this->received_word_hd = encoded;
@@ -306,6 +513,72 @@ template <class GF_q, class real> void ldpc<GF_q, real>::do_encode(
 #endif
    }
 
+template <class GF_q, class real> void ldpc<GF_q, real>::sparse_backsubstitute(
+      libbase::vector<GF_q>& codeword) const
+   {
+   for (int s = 0; s < this->enc_rows.size(); s++)
+      {
+      const int r = this->enc_rows(s);
+      const int c = this->enc_cols(s);
+      GF_q sum = GF_q(0);
+      for (int i = 0; i < this->N_m(r).size(); i++)
+         {
+         const int j = this->N_m(r)(i) - 1;
+         if (j != c)
+            sum += this->pchk_matrix(r, j) * codeword(j);
+         }
+      codeword(c) = GF_q(0) - sum / this->pchk_matrix(r, c);
+      }
+   }
+
+template <class GF_q, class real> void ldpc<GF_q, real>::sparse_encode(
+      const array1i_t & source, array1i_t& encoded) const
+   {
+   assert(source.size() == this->dim_k);
+   // set the info symbols, with gap symbols at zero
+   libbase::vector<GF_q> codeword(this->length_n);
+   codeword = GF_q(0);
+   for (int i = 0; i < this->dim_k; i++)
+      codeword(this->info_symb_pos(i)) = GF_q(source(i));
+   this->sparse_backsubstitute(codeword);
+   // determine the gap symbols from the syndrome at the unused rows
+   const int ng = this->gap_cols.size();
+   if (ng > 0)
+      {
+      const int nl = this->gap_rows.size();
+      libbase::vector<GF_q> syndrome(nl);
+      for (int l = 0; l < nl; l++)
+         {
+         const int r = this->gap_rows(l);
+         GF_q sum = GF_q(0);
+         for (int i = 0; i < this->N_m(r).size(); i++)
+            {
+            const int j = this->N_m(r)(i) - 1;
+            sum += this->pchk_matrix(r, j) * codeword(j);
+            }
+         syndrome(l) = sum;
+         }
+      // solve the unit upper-triangular gap system
+      libbase::vector<GF_q> gap(ng);
+      for (int b = ng - 1; b >= 0; b--)
+         {
+         GF_q sum = GF_q(0);
+         for (int l = 0; l < nl; l++)
+            sum += this->gap_transform(b, l) * syndrome(l);
+         for (int c = b + 1; c < ng; c++)
+            sum += this->gap_system(b, c) * gap(c);
+         gap(b) = GF_q(0) - sum;
+         }
+      for (int b = 0; b < ng; b++)
+         codeword(this->gap_cols(b)) = gap(b);
+      this->sparse_backsubstitute(codeword);
+      }
+   // copy result
+   encoded.init(this->length_n);
+   for (int i = 0; i < this->length_n; i++)
+      encoded(i) = codeword(i);
+   }
+
 template <class GF_q, class real> void ldpc<GF_q, real>::softdecode(
       array1vdbl_t& ri, array1vdbl_t& ro)
    {
@@ -392,8 +665,11 @@ template <class GF_q, class real> std::string ldpc<GF_q, real>::description() co
    libbase::trace << "Its parity check matrix is given by:" << std::endl;
    this->pchk_matrix.serialize(libbase::trace, '\n');
 
-   libbase::trace << "Its generator matrix is given by:" << std::endl;
-   this->gen_matrix.serialize(libbase::trace, '\n');
+   if (this->reduce_to_ref)
+      {
+      libbase::trace << "Its generator matrix is given by:" << std::endl;
+      this->gen_matrix.serialize(libbase::trace, '\n');
+      }
    libbase::trace << "The information symbols are located in columns:" << std::endl;
    for (int loop = 0; loop < this->dim_k; loop++)
       {
@@ -215,6 +215,24 @@ private:
    // has the right dimensions
    void init();
 
+   /*! \brief sets up the sparse encoder
+    * This triangulates the parity check matrix greedily, using its sparse
+    * structure (N_m, M_n), and determines the info symbol positions and the
+    * dimension of the code without computing the generator matrix.
+    */
+   void init_sparse_encoder();
+
+   /*! \brief encodes a source sequence using the sparse encoder
+    * This takes time linear in the number of non-zero entries of the parity
+    * check matrix, plus a small dense step for the gap columns.
+    */
+   void sparse_encode(const array1i_t & source, array1i_t& encoded) const;
+
+   /*! \brief solves for the triangular parity symbols in encoding order
+    * Info and gap symbols need to be set in the given codeword.
+    */
+   void sparse_backsubstitute(libbase::vector<GF_q>& codeword) const;
+
    /*! \brief checks whether the current solution is a codeword
     * This computes the syndrome of a received word using the fact that the matrix is sparse
     * However, as soon as the syndrome contains a non-zero value it stops as this means the
@@ -275,8 +293,32 @@ private:
    libbase::matrix<GF_q> pchk_matrix;
 
    //!The generator matrix of the code in REF
+   //(only used if reduce_to_ref is set)
    libbase::matrix<GF_q> gen_matrix;
 
+   //!Rows of the parity check matrix used to solve for each parity symbol,
+   //in encoding order (sparse encoder)
+   array1i_t enc_rows;
+
+   //!Positions of the parity symbols solved by back-substitution,
+   //in encoding order (sparse encoder)
+   array1i_t enc_cols;
+
+   //!Positions of the gap symbols, which cannot be solved by back-substitution
+   //and are found by solving a small dense system (sparse encoder)
+   array1i_t gap_cols;
+
+   //!Rows of the parity check matrix not used for back-substitution
+   //(sparse encoder)
+   array1i_t gap_rows;
+
+   //!Linear combinations of the syndromes at gap_rows giving the right-hand
+   //side of the gap system (sparse encoder)
+   libbase::matrix<GF_q> gap_transform;
+
+   //!The gap system, in unit upper-triangular form (sparse encoder)
+   libbase::matrix<GF_q> gap_system;
+
    //! the permutation that swaps the columns so that
    //the parity check matrix is in standard form, eg (I|P)
    array1i_t perm_to_systematic;
@@ -296,8 +338,10 @@ private:
 
    //! flag indicating whether the generator matrix should be reduced to
    //REF form in the hope of getting a proper systematic code.
-   //If set to false, initialisation is quicker and the info symbols are
-   //at the end of the codeword
+   //If set to false, the generator matrix is not computed; the code is
+   //encoded using the sparse parity check matrix, and initialisation is
+   //much quicker for long codes. The info symbols are at the positions
+   //not used as parity symbols by the sparse encoder.
    //If set to true, the info symbols will be at the beginning of the
    //code word.
    //Note that it is not guaranteed that they will be in the first
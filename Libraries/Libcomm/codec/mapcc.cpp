@@ -34,6 +34,11 @@ void mapcc<real, dbl>::init()
    assertalways(encoder);
    BCJR.init(*encoder, tau);
    assertalways(!circular || !endatzero);
+   // set up table-driven encoder, if the state table is small enough
+   if (encoder->num_states() * encoder->num_input_combinations() <= (1 << 16))
+      table.reset(new cached_fsm(*encoder));
+   else
+      table.reset();
    }
 
 template <class real, class dbl>
@@ -141,6 +146,28 @@ void mapcc<real, dbl>::do_encode(const array1i_t& source, array1i_t& encoded)
    array2i_t source1(tau, k);
    source1 = fsm::tail;
    source1.copyfrom(source);
+   // Use the table-driven encoder if available
+   if (table)
+      {
+      // Copy source, adding any necessary tail
+      array1i_t source2(tau * k);
+      source2 = fsm::tail;
+      source2.copyfrom(source);
+      // Reset the encoder to zero state
+      table->reset();
+      // When dealing with a circular system, perform first pass to determine
+      // end state, then reset to the corresponding circular state.
+      if (circular)
+         {
+         table->advance(&source2(0), tau);
+         encoder->resetcircular(table->state(), tau);
+         table->reset(encoder->state());
+         }
+      // Encode source stream
+      encoded.init(tau * n);
+      table->encode(&source2(0), tau, &encoded(0), n, 0, n, *encoder);
+      return;
+      }
    // Reset the encoder to zero state
    encoder->reset();
    // When dealing with a circular system, perform first pass to determine end
@@ -26,6 +26,7 @@
 
 #include "codec_softout.h"
 #include "fsm.h"
+#include "fsm/cached_fsm.h"
 #include "safe_bcjr.h"
 #include "itfunc.h"
 #include "serializer.h"
@@ -63,6 +64,7 @@ private:
    bool circular; //!< True for circular trellis
    // @}
    /*! \name Internal object representation */
+   boost::shared_ptr<cached_fsm> table; //!< Table-driven encoder (if state table is small enough)
    safe_bcjr<real, dbl> BCJR; //!< BCJR algorithm implementation
    double rate;
    array2d_t R; //!< BCJR a-priori receiver statistics
@@ -124,7 +126,10 @@ public:
          init();
          }
       else
+         {
          encoder.reset();
+         table.reset();
+         }
       return *this;
       }
    // @}
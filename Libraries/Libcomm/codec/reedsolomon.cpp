@@ -28,6 +28,7 @@
 
 #include "reedsolomon.h"
 #include "linear_code_utils.h"
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 #include <iostream>
@@ -81,253 +82,438 @@ void reedsolomon<GF_q>::do_init_decoder(const array1vd_t & ptable, const array1v
       }
    }
 
+// internal decoding functions
+
+/*!
+ * \brief Compute the syndrome of the given word
+ * \param[in] received Received (hard-decision) word
+ * \param[out] syndrome_vec Syndrome components S_1 .. S_{n-k}
+ * \return True if the syndrome is the zero vector
+ *
+ * Row j of the parity check matrix is given by the powers of alpha^{j+1}, so
+ * syndrome component j is the received polynomial evaluated at alpha^{j+1}.
+ * This is computed using Horner's rule, without reference to the matrix.
+ */
 template <class GF_q>
-void reedsolomon<GF_q>::softdecode(array1vd_t& ri, array1vd_t& ro)
+bool reedsolomon<GF_q>::compute_syndrome(const libbase::vector<GF_q>& received,
+      libbase::vector<GF_q>& syndrome_vec) const
    {
-   //determine the most likely symbol
-   hd_functor(this->received_likelihoods, this->received_word_hd);
-#if DEBUG>=2
-   this->received_word_hd.serialize(std::cout, ',');
-   std::cout << std::endl;
-#endif
-
-   //we use the PGZ algorithm for decoding General BCH codes (note that RS codes are
-   //narrow-sense BCH codes.
-   //see
-   // http://en.wikipedia.org/wiki/BCH_code#Peterson_Gorenstein_Zierler_algorithm
-   //for details.
-
-   /*
-    * The algorithm works as follows:
-    * 1) calculate the syndrome of the received word
-    * 2) calculate the error locator polynominal
-    * 3) calculate the roots of the polynomial to get the error positions
-    * 4) calculate the error-values at these locations.
-    *
-    */
-
-   // in case of decoding failure we simply return the received probabilities
-   ro = this->received_likelihoods;
-
-   // Calculate the syndrome of the received word
-   // (and flag whether we decoded successfully)
-   libbase::vector<GF_q> syndrome_vec;
-   const bool dec_success =
-         libbase::linear_code_utils<GF_q, double>::compute_syndrome(
-               this->pchk_matrix, this->received_word_hd, syndrome_vec);
+   assert(received.size() == this->length_n);
+   syndrome_vec.init(this->dim_pchk);
+   bool zero = true;
+   const GF_q alpha = GF_q(2);
+   GF_q beta = alpha;
+   for (int j = 0; j < this->dim_pchk; j++)
+      {
+      GF_q tmp_val = received(this->length_n - 1);
+      for (int i = this->length_n - 2; i >= 0; i--)
+         tmp_val = tmp_val * beta + received(i);
+      syndrome_vec(j) = tmp_val;
+      if (tmp_val != GF_q(0))
+         zero = false;
+      beta *= alpha;
+      }
+   return zero;
+   }
 
+/*!
+ * \brief Berlekamp-Massey decoder
+ * \param[in] syndrome_vec Syndrome of the received (hard-decision) word
+ * \param[out] corrected Corrected codeword
+ * \return True if a consistent codeword was found
+ *
+ * The algorithm works as follows:
+ * 1) determine the error locator polynomial \Lambda(x) using the BM
+ *    algorithm [cf. Lin & Costello, 2004, sec. 6.2]
+ * 2) find its roots by a Chien search; a root at \alpha^{-i} indicates an
+ *    error at position i
+ * 3) determine the error values using Forney's algorithm, with the error
+ *    evaluator polynomial \Omega(x) = S(x) \Lambda(x) mod x^{2t}
+ *
+ * Decoding fails if the degree of the locator polynomial exceeds t or if the
+ * number of roots found differs from this degree.
+ *
+ * \note Since the field has characteristic 2, the formal derivative of a
+ * polynomial keeps only the odd-power terms, and subtraction is addition.
+ */
+template <class GF_q>
+bool reedsolomon<GF_q>::decode_bm(const libbase::vector<GF_q>& syndrome_vec,
+      libbase::vector<GF_q>& corrected) const
+   {
+   const int t = this->dim_pchk / 2;
+   const int n2t = 2 * t;
+   // 1) Berlekamp-Massey algorithm
+   libbase::vector<GF_q> lambda(n2t + 1); // error locator polynomial
+   libbase::vector<GF_q> b(n2t + 1); // last locator before a length change
+   libbase::vector<GF_q> tmp;
+   lambda = GF_q(0);
+   lambda(0) = GF_q(1);
+   b = GF_q(0);
+   b(0) = GF_q(1);
+   int L = 0; // current length of the LFSR
+   int m = 1; // steps since b was last updated
+   GF_q db = GF_q(1); // discrepancy when b was last updated
+   for (int r = 0; r < n2t; r++)
+      {
+      // compute discrepancy
+      GF_q d = syndrome_vec(r);
+      for (int i = 1; i <= L; i++)
+         d += lambda(i) * syndrome_vec(r - i);
+      if (d == GF_q(0))
+         {
+         m++;
+         continue;
+         }
+      const GF_q scale = d / db;
+      if (2 * L <= r)
+         tmp = lambda;
+      for (int i = m; i <= n2t; i++)
+         lambda(i) -= scale * b(i - m);
+      if (2 * L <= r)
+         {
+         L = r + 1 - L;
+         b = tmp;
+         db = d;
+         m = 1;
+         }
+      else
+         m++;
+      }
+   if (L > t)
+      return false;
 #if DEBUG>=2
-   std::cout << std::endl << "The received word is given by:" << std::endl;
-   this->received_word_hd.serialize(std::cout, ',');
-   std::cout << std::endl << "Its syndrome is given by:" << std::endl;
-   syndrome_vec.serialize(std::cout, ',');
+   std::cout << std::endl << "The coeffs of the error locator polynomial are given by:" << std::endl;
+   lambda.extract(0, L + 1).serialize(std::cout, ',');
 #endif
-   if (dec_success)
+   // 2) Chien search: term(j) holds lambda_j . alpha^{-ij} for position i
+   const GF_q alpha = GF_q(2);
+   const GF_q alpha_inv = alpha.inverse();
+   libbase::vector<GF_q> term = lambda.extract(0, L + 1);
+   libbase::vector<GF_q> step(L + 1);
+   step(0) = GF_q(1);
+   for (int j = 1; j <= L; j++)
+      step(j) = step(j - 1) * alpha_inv;
+   array1i_t error_pos(L);
+   int rootsfound = 0;
+   for (int i = 0; i < this->length_n && rootsfound < L; i++)
       {
-      // HD word must be correct, so set posteriors from this
-      ro = double(0);
-      for (int i = 0; i < this->length_n; i++)
-         ro(i)(this->received_word_hd(i)) = double(1);
+      GF_q sum = GF_q(0);
+      for (int j = 0; j <= L; j++)
+         sum += term(j);
+      if (sum == GF_q(0))
+         error_pos(rootsfound++) = i;
+      for (int j = 1; j <= L; j++)
+         term(j) *= step(j);
       }
-   else //do some error correction as the syndrome is non-zero
+   if (rootsfound != L)
+      return false;
+   // 3) Forney algorithm: omega(x) = S(x) lambda(x) mod x^{2t}
+   libbase::vector<GF_q> omega(n2t);
+   for (int i = 0; i < n2t; i++)
       {
-      //we can correct t errors and dmin=n-k+1.
-      //note that we have dim_pck=(n-k)>=2t
-      int t = (this->length_n - this->dim_k) / 2;
-
-      //the syndrome matrix
-      libbase::matrix<GF_q> syndrome_matrix;
-      //its REF form
-      libbase::matrix<GF_q> syndrome_ref_matrix;
-      //the determinant of the syndrome matrix
-      GF_q det = GF_q(1);
-
-      //this is now the PGZ algorithm whose aim it is to
-      //determine the error locator polynomial of the form
-      // \lambda(x)=1 + \lambda_1 x +\lambda_2 x^2 + .. + \lambda_w x^w
-      //where w<=t.
-      do {
-         //we now generate the t*(t+1) syndrome matrix
-         /*
-          *    [ s_1    s_2     s_3   ...     s_t   ]
-          *    [ s_2    s_3     s_4   ...   s_{t+1} ]
-          *  S=[ s_3    s_4     s_5   ...   s_{t+2} ]
-          *    [ ...    ...     ...   ...     ...   ]
-          *    [ s_t  s_{t+1} s_{t+2} ...  s_{2t-1} ]
-          *
-          */
-         syndrome_matrix.init(t, t + 1);
-         for (int rows = 0; rows < t; rows++)
-            {
-            for (int cols = 0; cols < t; cols++)
-               {
-               syndrome_matrix(rows, cols) = syndrome_vec(cols + rows);
-               }
-            }
-         //this is C_{tx1}=(s_{t+1},s_{t+2}, ... ,s_{2t-1}]^t
-         //we just stick this at the end of the syndrome matrix
-         for (int rows = 0; rows < t; rows++)
+      GF_q val = GF_q(0);
+      for (int j = 0; j <= std::min(i, L); j++)
+         val += lambda(j) * syndrome_vec(i - j);
+      omega(i) = val;
+      }
+   corrected = this->received_word_hd;
+   for (int k = 0; k < L; k++)
+      {
+      // X^{-1} for this error position
+      GF_q xinv = GF_q(1);
+      for (int i = 0; i < error_pos(k); i++)
+         xinv *= alpha_inv;
+      // evaluate omega(X^{-1}) by Horner's rule
+      GF_q num = omega(n2t - 1);
+      for (int i = n2t - 2; i >= 0; i--)
+         num = num * xinv + omega(i);
+      // evaluate lambda'(X^{-1}), keeping only odd-power terms
+      GF_q den = GF_q(0);
+      GF_q xpow = GF_q(1); // X^{-(j-1)}
+      for (int j = 1; j <= L; j++)
+         {
+         if (j % 2 == 1)
+            den += lambda(j) * xpow;
+         xpow *= xinv;
+         }
+      if (den == GF_q(0))
+         return false;
+      corrected(error_pos(k)) -= num / den;
+      }
+#if DEBUG>=2
+   std::cout << "This is the word we should have received:" << std::endl;
+   corrected.serialize(std::cout, ',');
+   std::cout << std::endl;
+#endif
+   return true;
+   }
+
+/*!
+ * \brief Peterson-Gorenstein-Zierler decoder
+ * \param[in] syndrome_vec Syndrome of the received (hard-decision) word
+ * \param[out] corrected Corrected codeword
+ * \return True if a consistent codeword was found
+ *
+ * We use the PGZ algorithm for decoding General BCH codes (note that RS codes
+ * are narrow-sense BCH codes). See
+ * http://en.wikipedia.org/wiki/BCH_code#Peterson_Gorenstein_Zierler_algorithm
+ * for details.
+ *
+ * The algorithm works as follows:
+ * 1) calculate the error locator polynominal
+ * 2) calculate the roots of the polynomial to get the error positions
+ * 3) calculate the error-values at these locations.
+ */
+template <class GF_q>
+bool reedsolomon<GF_q>::decode_pgz(const libbase::vector<GF_q>& syndrome_vec,
+      libbase::vector<GF_q>& corrected) const
+   {
+   //we can correct t errors and dmin=n-k+1.
+   //note that we have dim_pck=(n-k)>=2t
+   int t = (this->length_n - this->dim_k) / 2;
+
+   //the syndrome matrix
+   libbase::matrix<GF_q> syndrome_matrix;
+   //its REF form
+   libbase::matrix<GF_q> syndrome_ref_matrix;
+   //the determinant of the syndrome matrix
+   GF_q det = GF_q(1);
+
+   //this is now the PGZ algorithm whose aim it is to
+   //determine the error locator polynomial of the form
+   // \lambda(x)=1 + \lambda_1 x +\lambda_2 x^2 + .. + \lambda_w x^w
+   //where w<=t.
+   do {
+      //we now generate the t*(t+1) syndrome matrix
+      /*
+       *    [ s_1    s_2     s_3   ...     s_t   ]
+       *    [ s_2    s_3     s_4   ...   s_{t+1} ]
+       *  S=[ s_3    s_4     s_5   ...   s_{t+2} ]
+       *    [ ...    ...     ...   ...     ...   ]
+       *    [ s_t  s_{t+1} s_{t+2} ...  s_{2t-1} ]
+       *
+       */
+      syndrome_matrix.init(t, t + 1);
+      for (int rows = 0; rows < t; rows++)
+         {
+         for (int cols = 0; cols < t; cols++)
             {
-            syndrome_matrix(rows, t) = syndrome_vec(t + rows);
+            syndrome_matrix(rows, cols) = syndrome_vec(cols + rows);
             }
-         //compute the determinant of the syndrome matrix
-         //which will in fact compute the solution to the following
-         //system
-         // S * [\lambda_1, \lambda_2,...,\lambda_t]^t=C_{tx1}^t
-         syndrome_ref_matrix = syndrome_matrix.reduce_to_ref();
+         }
+      //this is C_{tx1}=(s_{t+1},s_{t+2}, ... ,s_{2t-1}]^t
+      //we just stick this at the end of the syndrome matrix
+      for (int rows = 0; rows < t; rows++)
+         {
+         syndrome_matrix(rows, t) = syndrome_vec(t + rows);
+         }
+      //compute the determinant of the syndrome matrix
+      //which will in fact compute the solution to the following
+      //system
+      // S * [\lambda_1, \lambda_2,...,\lambda_t]^t=C_{tx1}^t
+      syndrome_ref_matrix = syndrome_matrix.reduce_to_ref();
 
 #if DEBUG>=2
-         std::cout << std::endl << "The syndrome matrix is given by:" << std::endl;
-         syndrome_matrix.serialize(std::cout, '\n');
-         std::cout << std::endl << "The syndrome matrix in REF is given by:" << std::endl;
-         syndrome_ref_matrix.serialize(std::cout, '\n');
+      std::cout << std::endl << "The syndrome matrix is given by:" << std::endl;
+      syndrome_matrix.serialize(std::cout, '\n');
+      std::cout << std::endl << "The syndrome matrix in REF is given by:" << std::endl;
+      syndrome_ref_matrix.serialize(std::cout, '\n');
 #endif
 
-         det = GF_q(1);
-         for (int diag = 0; diag < t; diag++)
-            {
-            det *= syndrome_ref_matrix(diag, diag);
-            }
-         if (0 == det)
-            {
-            //empty error locator polynomial
-            t--;
-            }
-         } while ((GF_q(0) == det) && (t >= 1));
+      det = GF_q(1);
+      for (int diag = 0; diag < t; diag++)
+         {
+         det *= syndrome_ref_matrix(diag, diag);
+         }
+      if (0 == det)
+         {
+         //empty error locator polynomial
+         t--;
+         }
+      } while ((GF_q(0) == det) && (t >= 1));
 
-      //only start decoding if det!=0
-      if (GF_q(0) != det)
+   //only start decoding if det!=0
+   if (GF_q(0) != det)
+      {
+      //We can now read off the coefficients of the error locator polynomial
+      libbase::vector<GF_q> error_loc_poly;
+      error_loc_poly.init(t + 1);
+      error_loc_poly(0) = 1;
+      for (int rows = 1; rows <= t; rows++)
          {
-         //We can now read off the coefficients of the error locator polynomial
-         libbase::vector<GF_q> error_loc_poly;
-         error_loc_poly.init(t + 1);
-         error_loc_poly(0) = 1;
-         for (int rows = 1; rows <= t; rows++)
-            {
-            error_loc_poly(rows) = GF_q(syndrome_ref_matrix(t - rows, t));
-            }
-         //we now want to factor the error locator polynomial as follows:
-         //\lambda(x)=(X_w x +1)(X_{w-1} x +1) ... (X_1 x +1)
-         //          =\lamba_w x^w+\lamba_{w-1} x^{w-1}+...+\lambda_1 x + 1
-         //the X_i indicate the error positions of the received word as follows:
-         //Suppose that errors happened at positions, j_1, j_2, ..,j_w then
-         //X_i=\alpha^{j_i}.
+         error_loc_poly(rows) = GF_q(syndrome_ref_matrix(t - rows, t));
+         }
+      //we now want to factor the error locator polynomial as follows:
+      //\lambda(x)=(X_w x +1)(X_{w-1} x +1) ... (X_1 x +1)
+      //          =\lamba_w x^w+\lamba_{w-1} x^{w-1}+...+\lambda_1 x + 1
+      //the X_i indicate the error positions of the received word as follows:
+      //Suppose that errors happened at positions, j_1, j_2, ..,j_w then
+      //X_i=\alpha^{j_i}.
 #if DEBUG>=2
-         std::cout
-         << std::endl << "The coeffs of the error locator polynomial are given by:" << std::endl;
-         error_loc_poly.serialize(std::cout, ',');
+      std::cout
+      << std::endl << "The coeffs of the error locator polynomial are given by:" << std::endl;
+      error_loc_poly.serialize(std::cout, ',');
 #endif
 
-         //Use brute force and horner's scheme to determine the roots.
-         //we can stop as soon as we have found t=deg(\lambda(x)) roots
-         array1i_t error_pos;
-         error_pos.init(t);
-         GF_q alpha = GF_q(2); //represents \alpha
-         int counter = 0;
-         GF_q pow_alpha = GF_q(1); // represent \alpha^counter;
-         int rootsfound = 0;
-         while ((rootsfound < t) && (counter < this->length_n))
+      //Use brute force and horner's scheme to determine the roots.
+      //we can stop as soon as we have found t=deg(\lambda(x)) roots
+      array1i_t error_pos;
+      error_pos.init(t);
+      GF_q alpha = GF_q(2); //represents \alpha
+      int counter = 0;
+      GF_q pow_alpha = GF_q(1); // represent \alpha^counter;
+      int rootsfound = 0;
+      while ((rootsfound < t) && (counter < this->length_n))
+         {
+         GF_q tmp_val = error_loc_poly(t);
+         for (int j = t; j > 0; j--)
             {
-            GF_q tmp_val = error_loc_poly(t);
-            for (int j = t; j > 0; j--)
-               {
-               tmp_val = tmp_val * pow_alpha + error_loc_poly(j - 1);
-               }
-            if (tmp_val == GF_q(0))
+            tmp_val = tmp_val * pow_alpha + error_loc_poly(j - 1);
+            }
+         if (tmp_val == GF_q(0))
+            {
+            //we have found a root, \beta=\alpha^s of the error locator polynomial, eg say
+            //(X_1 \beta +1)=0 then X_1=\frac{1}{\beta}=\alpha^{-s}
+            //Now X_1=\alpha^{j_1} this means that j_1=-s and as we only deal with powers between
+            // 0 and q-1 we need to set j_1 to either 0 or (q-1)-s
+            int pos_inv = this->length_n - counter;
+            if (pos_inv == this->length_n)
                {
-               //we have found a root, \beta=\alpha^s of the error locator polynomial, eg say
-               //(X_1 \beta +1)=0 then X_1=\frac{1}{\beta}=\alpha^{-s}
-               //Now X_1=\alpha^{j_1} this means that j_1=-s and as we only deal with powers between
-               // 0 and q-1 we need to set j_1 to either 0 or (q-1)-s
-               int pos_inv = this->length_n - counter;
-               if (pos_inv == this->length_n)
-                  {
-                  pos_inv = 0;
-                  }
-               error_pos(rootsfound) = pos_inv;
-               rootsfound++;
+               pos_inv = 0;
                }
-            //increment the counter
-            counter++;
-            //up the power
-            pow_alpha *= alpha;
+            error_pos(rootsfound) = pos_inv;
+            rootsfound++;
             }
+         //increment the counter
+         counter++;
+         //up the power
+         pow_alpha *= alpha;
+         }
 
 #if DEBUG>=2
-         if (rootsfound > 0)
+      if (rootsfound > 0)
+         {
+         std::cout << std::endl << "We found roots at:" << std::endl;
+         for (int loop1 = 0; loop1 < rootsfound; loop1++)
             {
-            std::cout << std::endl << "We found roots at:" << std::endl;
-            for (int loop1 = 0; loop1 < rootsfound; loop1++)
-               {
-               std::count << error_pos(loop1) << ", ";
-               }
+            std::count << error_pos(loop1) << ", ";
             }
+         }
 #endif
-         //only continue if we found some roots...
-         if (rootsfound != 0)
+      //only continue if we found some roots...
+      if (rootsfound != 0)
+         {
+         //we have found some roots and hence the error locations
+         //We can now work out the error values
+         libbase::matrix<GF_q> error_mat;
+         libbase::matrix<GF_q> error_ref_mat;
+         error_mat.init(this->dim_pchk, rootsfound + 1);
+         for (int rows = 0; rows < this->dim_pchk; rows++)
             {
-            //we have found some roots and hence the error locations
-            //We can now work out the error values
-            libbase::matrix<GF_q> error_mat;
-            libbase::matrix<GF_q> error_ref_mat;
-            error_mat.init(this->dim_pchk, rootsfound + 1);
-            for (int rows = 0; rows < this->dim_pchk; rows++)
-               {
-               for (int cols = 0; cols < rootsfound; cols++)
-                  {
-                  error_mat(rows, cols) = this->pchk_matrix(rows,
-                        error_pos(cols));
-                  }
-               }
-            for (int rows = 0; rows < this->dim_pchk; rows++)
+            for (int cols = 0; cols < rootsfound; cols++)
                {
-               error_mat(rows, rootsfound) = syndrome_vec(rows);
+               error_mat(rows, cols) = this->pchk_matrix(rows,
+                     error_pos(cols));
                }
-            //reduce to REF to obtain the error values
-            error_ref_mat = error_mat.reduce_to_ref();
+            }
+         for (int rows = 0; rows < this->dim_pchk; rows++)
+            {
+            error_mat(rows, rootsfound) = syndrome_vec(rows);
+            }
+         //reduce to REF to obtain the error values
+         error_ref_mat = error_mat.reduce_to_ref();
 
 #if DEBUG>=2
-            std::cout << std::endl << "The error matrix is given by:" << std::endl;
-            error_mat.serialize(std::cout, '\n');
-            std::cout << std::endl << "The error matrix in REF is given by:" << std::endl;
-            error_ref_mat.serialize(std::cout, '\n');
+         std::cout << std::endl << "The error matrix is given by:" << std::endl;
+         error_mat.serialize(std::cout, '\n');
+         std::cout << std::endl << "The error matrix in REF is given by:" << std::endl;
+         error_ref_mat.serialize(std::cout, '\n');
 #endif
 
-            //we only have a consistent solution if the following value is 0
-            if (error_ref_mat(rootsfound, rootsfound) == GF_q(0))
+         //we only have a consistent solution if the following value is 0
+         if (error_ref_mat(rootsfound, rootsfound) == GF_q(0))
+            {
+            corrected = this->received_word_hd;
+
+            //work out the proper code word
+            for (int rows = 0; rows < rootsfound; rows++)
                {
-               libbase::vector<GF_q> tmp_received_hd;
-               tmp_received_hd = this->received_word_hd;
-
-               //work out the proper code word
-               for (int rows = 0; rows < rootsfound; rows++)
-                  {
-                  int col = error_pos(rows);
-                  GF_q tmp_val = GF_q(tmp_received_hd(col))
-                        - error_ref_mat(rows, rootsfound);
-                  tmp_received_hd(col) = tmp_val;
-                  }
+               int col = error_pos(rows);
+               GF_q tmp_val = GF_q(corrected(col))
+                     - error_ref_mat(rows, rootsfound);
+               corrected(col) = tmp_val;
+               }
 #if DEBUG>=2
-               std::cout << "This is the word we should have received:" << std::endl;
-               tmp_received_hd.serialize(std::cout, ',');
-               std::cout << std::endl;
+            std::cout << "This is the word we should have received:" << std::endl;
+            corrected.serialize(std::cout, ',');
+            std::cout << std::endl;
 #endif
-               // decoded HD word is consistent, so set posteriors from this
-               ro = double(0);
-               for (int i = 0; i < this->length_n; i++)
-                  ro(i)(tmp_received_hd(i)) = double(1);
-               }
+            // decoded HD word is consistent
+            return true;
             }
          }
       }
-   // Set input-referred posteriors from output-refered ones
-   ri = ro.extract(this->dim_pchk, this->dim_k);
+   return false;
+   }
 
+template <class GF_q>
+void reedsolomon<GF_q>::softdecode(array1vd_t& ri, array1vd_t& ro)
+   {
+   //determine the most likely symbol
+   hd_functor(this->received_likelihoods, this->received_word_hd);
 #if DEBUG>=2
-   std::cout << std::endl << "The decoded word is given by:" << std::endl;
-   decoded.serialize(std::cout, ',');
+   this->received_word_hd.serialize(std::cout, ',');
    std::cout << std::endl;
 #endif
+
+   // in case of decoding failure we simply return the received probabilities
+   ro = this->received_likelihoods;
+
+   // Calculate the syndrome of the received word
+   // (and flag whether we decoded successfully)
+   libbase::vector<GF_q> syndrome_vec;
+   const bool dec_success = compute_syndrome(this->received_word_hd,
+         syndrome_vec);
+
+#if DEBUG>=2
+   std::cout << std::endl << "The received word is given by:" << std::endl;
+   this->received_word_hd.serialize(std::cout, ',');
+   std::cout << std::endl << "Its syndrome is given by:" << std::endl;
+   syndrome_vec.serialize(std::cout, ',');
+#endif
+   if (dec_success)
+      {
+      // HD word must be correct, so set posteriors from this
+      ro = double(0);
+      for (int i = 0; i < this->length_n; i++)
+         ro(i)(this->received_word_hd(i)) = double(1);
+      }
+   else //do some error correction as the syndrome is non-zero
+      {
+      libbase::vector<GF_q> corrected;
+      bool consistent = false;
+      switch (decoder)
+         {
+         case decoder_pgz:
+            consistent = decode_pgz(syndrome_vec, corrected);
+            break;
+         case decoder_bm:
+            consistent = decode_bm(syndrome_vec, corrected);
+            break;
+         default:
+            failwith("Unknown decoder");
+            break;
+         }
+      // if decoded HD word is consistent, set posteriors from this
+      if (consistent)
+         {
+         ro = double(0);
+         for (int i = 0; i < this->length_n; i++)
+            ro(i)(corrected(i)) = double(1);
+         }
+      }
+   // Set input-referred posteriors from output-refered ones
+   ri = ro.extract(this->dim_pchk, this->dim_k);
    }
 
 template <class GF_q>
@@ -336,6 +522,18 @@ std::string reedsolomon<GF_q>::description() const
 
    std::ostringstream sout;
    sout << "RS code [" << this->length_n << ", " << this->dim_k << "] ";
+   switch (decoder)
+      {
+      case decoder_pgz:
+         sout << "PGZ decoder";
+         break;
+      case decoder_bm:
+         sout << "BM decoder";
+         break;
+      default:
+         failwith("Unknown decoder");
+         break;
+      }
 
    libbase::trace << "Its parity check matrix is:" << std::endl;
 
@@ -526,11 +724,14 @@ void reedsolomon<GF_q>::init()
  * This method outputs the following format
  *
  * reedsolomon<gfq>
+ * version
+ * decoder
  * n
  * k
  *
  * where
  * q is the size of the finite field, ie GF(q)
+ * decoder is the decoding algorithm (pgz|bm)
  * n is the length of the code
  * k is its dimension
  *
@@ -539,6 +740,21 @@ template <class GF_q>
 std::ostream& reedsolomon<GF_q>::serialize(std::ostream& sout) const
    {
    // format version
+   sout << "# Version" << std::endl;
+   sout << 1 << std::endl;
+   sout << "# Decoder (pgz|bm)" << std::endl;
+   switch (decoder)
+      {
+      case decoder_pgz:
+         sout << "pgz" << std::endl;
+         break;
+      case decoder_bm:
+         sout << "bm" << std::endl;
+         break;
+      default:
+         failwith("Unknown decoder");
+         break;
+      }
    sout << "# Length of the code (n)" << std::endl;
    sout << this->length_n << std::endl;
    sout << "# Dimension of the code (k)" << std::endl;
@@ -551,16 +767,23 @@ std::ostream& reedsolomon<GF_q>::serialize(std::ostream& sout) const
  * This method oxpects the following format
  *
  * reedsolomon
+ * version
+ * decoder
  * n
  * k
  * m
  *
  * where
+ * decoder is the decoding algorithm (pgz|bm)
  * n is the length of the code
  * k is its dimension
  * m determines the size of the finite field, eg GF(2^m)
  * note that we must have 1<k<n<2^m+1 and m<=10
  *
+ * \version 0 Initial version (un-numbered, starts with n)
+ *
+ * \version 1 Added choice of decoder; since n=q-1 >= 3, an initial value
+ * of 1 is unambiguously a version number
  */
 
 template <class GF_q>
@@ -569,8 +792,23 @@ std::istream& reedsolomon<GF_q>::serialize(std::istream& sin)
    assertalways(sin.good());
 
    int length, dim;
-   //get the length
+   //get the version or length (for un-numbered files)
    sin >> libbase::eatcomments >> length >> libbase::verify;
+   // default decoder for old-format files
+   decoder = decoder_pgz;
+   if (length == 1)
+      {
+      std::string s;
+      sin >> libbase::eatcomments >> s >> libbase::verify;
+      if (s == "pgz")
+         decoder = decoder_pgz;
+      else if (s == "bm")
+         decoder = decoder_bm;
+      else
+         failwith("Unknown decoder");
+      //get the length
+      sin >> libbase::eatcomments >> length >> libbase::verify;
+      }
    //get the dimension;
    sin >> libbase::eatcomments >> dim >> libbase::verify;
    //initialise the codec with this information
@@ -43,8 +43,17 @@ namespace libcomm {
  * \author S Wesemeyer
  * This class will construct a Reed-Solomon code over F_{q} of length n and dimension k
  * Note that n is either q or q-1 and 1<k<n-1
- * The Berlekamp algorithm is used to decode any received word.
  *
+ * Two hard-decision decoders are available, selected in the system file:
+ * - the Peterson-Gorenstein-Zierler (PGZ) algorithm, which solves the key
+ *   equation by matrix reduction for each candidate number of errors
+ * - the Berlekamp-Massey (BM) algorithm, with a Chien search for the error
+ *   locations and Forney's algorithm for the error values; this has a
+ *   complexity of O(t^2) for the key equation, and is preferred for codes
+ *   with large t
+ *
+ * In both cases the syndrome is obtained by evaluating the received word at
+ * the roots of the generator polynomial using Horner's rule.
  */
 template <class GF_q>
 class reedsolomon : public codec_softout<libbase::vector, double> {
@@ -83,11 +92,21 @@ protected:
    void do_init_decoder(const array1vd_t& ptable);
    void do_init_decoder(const array1vd_t& ptable, const array1vd_t& app);
 
+private:
+   /*! \name Internal decoding functions */
+   bool compute_syndrome(const libbase::vector<GF_q>& received,
+         libbase::vector<GF_q>& syndrome_vec) const;
+   bool decode_pgz(const libbase::vector<GF_q>& syndrome_vec,
+         libbase::vector<GF_q>& corrected) const;
+   bool decode_bm(const libbase::vector<GF_q>& syndrome_vec,
+         libbase::vector<GF_q>& corrected) const;
+   // @}
+
 public:
    //!default constructor needed for serialization
-   reedsolomon()
+   reedsolomon() :
+         decoder(decoder_pgz)
       {
-      //nothing to do
       }
 
    /*! \name Codec operations */
@@ -182,6 +201,12 @@ public:
 DECLARE_SERIALIZER(reedsolomon)
 
 private:
+   //! the decoding algorithm to use
+   enum decoder_t {
+      decoder_pgz = 0, //!< Peterson-Gorenstein-Zierler
+      decoder_bm, //!< Berlekamp-Massey + Chien + Forney
+      decoder_undefined
+   } decoder;
    //! the length of the code
    int length_n;
    //! the dimension of the code
@@ -49,6 +49,11 @@ void repacc<real, dbl>::init()
    assertalways(rep.num_inputs() == This::num_inputs());
    // initialize BCJR subsystem for accumulator
    BCJR.init(*acc, This::acc_timesteps());
+   // set up table-driven accumulator, if the state table is small enough
+   if (acc->num_states() * acc->num_input_combinations() <= (1 << 16))
+      table.reset(new cached_fsm(*acc));
+   else
+      table.reset();
    // check interleaver size
    assertalways(inter->size() == This::acc_timesteps());
    assertalways(iter > 0);
@@ -202,17 +207,30 @@ void repacc<real, dbl>::do_encode(const array1i_t& source, array1i_t& encoded)
 
    // Initialise result vector
    encoded.init(This::output_block_size());
-   // Reset the encoder to zero state
-   acc->reset();
-   // Encode sequence
-   for (int i = 0; i < tau; i++)
+   if (table)
       {
-      array1i_t ip = rep2.segment(i * k, k);
-      encoded.segment(i * p, p) = acc->step(ip).extract(k, p);
+      // Reset the encoder to zero state
+      table->reset();
+      // Encode sequence
+      table->encode(&rep2(0), tau, &encoded(0), p, k, p, *acc);
+      // check that encoder finishes correctly
+      if (endatzero)
+         assertalways(table->packed_state() == 0);
+      }
+   else
+      {
+      // Reset the encoder to zero state
+      acc->reset();
+      // Encode sequence
+      for (int i = 0; i < tau; i++)
+         {
+         array1i_t ip = rep2.segment(i * k, k);
+         encoded.segment(i * p, p) = acc->step(ip).extract(k, p);
+         }
+      // check that encoder finishes correctly
+      if (endatzero)
+         assertalways(fsm::convert(acc->state(), acc->num_symbols()) == 0);
       }
-   // check that encoder finishes correctly
-   if (endatzero)
-      assertalways(fsm::convert(acc->state(), acc->num_symbols()) == 0);
 #if DEBUG>=2
    std::cerr << "Accumulator:" << std::endl;
    encoded.serialize(std::cerr, '\n');
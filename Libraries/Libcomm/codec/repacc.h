@@ -26,6 +26,7 @@
 #include "codec_softout.h"
 #include "memoryless.h"
 #include "fsm.h"
+#include "fsm/cached_fsm.h"
 #include "interleaver.h"
 #include "safe_bcjr.h"
 
@@ -70,6 +71,7 @@ private:
    // @}
 protected:
    /*! \name Internal object representation */
+   boost::shared_ptr<cached_fsm> table; //!< Table-driven accumulator (if state table is small enough)
    safe_bcjr<real, dbl> BCJR; //!< BCJR algorithm implementation
    bool initialised; //!< Flag to indicate when memory is initialised
    array1vd_t rp; //!< Intrinsic source statistics (natural)
@@ -47,6 +47,11 @@ void turbo<real, dbl>::init()
    const int tau = num_timesteps();
    assertalways(tau > 0);
    BCJR.init(*encoder, tau);
+   // set up table-driven encoder, if the state table is small enough
+   if (encoder->num_states() * encoder->num_input_combinations() <= (1 << 16))
+      table.reset(new cached_fsm(*encoder));
+   else
+      table.reset();
 
    assertalways(!endatzero || !circular);
    assertalways(iter > 0);
@@ -367,6 +372,13 @@ void turbo<real, dbl>::do_encode(const array1i_t& source, array1i_t& encoded)
    // Derived sizes
    const int s = k + p * sets;
 
+   // Use the table-driven encoder if available
+   if (table)
+      {
+      do_encode_table(source, encoded);
+      return;
+      }
+
    // Reform source into a matrix, with one row per timestep
    // and adding any necessary tail
    array2i_t source1(tau, k);
@@ -440,6 +452,89 @@ void turbo<real, dbl>::do_encode(const array1i_t& source, array1i_t& encoded)
       }
    }
 
+/*!
+ * \brief Encode using the state table
+ *
+ * Same as the general encoding process, but each set is encoded in a single
+ * pass over contiguous integer arrays, with one lookup per time-step; the
+ * original encoder is only used to determine tail inputs and the circulation
+ * state.
+ */
+template <class real, class dbl>
+void turbo<real, dbl>::do_encode_table(const array1i_t& source,
+      array1i_t& encoded)
+   {
+   // Inherit sizes
+   const int sets = num_sets();
+   const int tau = num_timesteps();
+   const int k = enc_inputs();
+   const int p = enc_parity();
+   // Derived sizes
+   const int s = k + p * sets;
+
+   // Initialise result vector, with one segment of size 's' per timestep
+   encoded.init(This::output_block_size());
+   int *const out = &encoded(0);
+
+   // Copy source into the systematic positions, adding any necessary tail
+   for (int t = 0; t < tau; t++)
+      for (int i = 0; i < k; i++)
+         {
+         const int ndx = t * k + i;
+         out[t * s + i] = (ndx < source.size()) ? source(ndx) : fsm::tail;
+         }
+
+   // Space for the source, one column per encoder input
+   array1i_t source1(tau);
+   array1i_t source2;
+   array1i_t src(tau * k);
+   // Consider sets in order
+   for (int set = 0; set < sets; set++)
+      {
+      // Create interleaved version of source
+      for (int i = 0; i < k; i++)
+         {
+         for (int t = 0; t < tau; t++)
+            source1(t) = out[t * s + i];
+         inter(set)->transform(source1, source2);
+         for (int t = 0; t < tau; t++)
+            src(t * k + i) = source2(t);
+         }
+
+      // Reset the encoder to zero state
+      table->reset();
+
+      // When dealing with a circular system, perform first pass to determine
+      // end state, then reset to the corresponding circular state.
+      int cstate = 0;
+      if (circular)
+         {
+         table->advance(&src(0), tau);
+         encoder->resetcircular(table->state(), tau);
+         table->reset(encoder->state());
+         cstate = table->packed_state();
+         }
+
+      // Encode source, writing parity directly into the output
+      // (non-interleaved must be done first to determine tail bit values)
+      table->encode(&src(0), tau, out + k + p * set, s, k, p, *encoder);
+
+      // If this was the first (non-interleaved) set, copy back the source
+      // to fix the tail bit values, if any
+      if (endatzero && set == 0)
+         for (int t = 0; t < tau; t++)
+            for (int i = 0; i < k; i++)
+               out[t * s + i] = src(t * k + i);
+
+      // check that encoder finishes correctly
+      const int finstate = table->packed_state();
+      if (circular)
+         assertalways(finstate == cstate);
+      if (endatzero)
+         assertalways(finstate == 0);
+      }
+   }
+
 template <class real, class dbl>
 void turbo<real, dbl>::softdecode(array1vd_t& ri)
    {
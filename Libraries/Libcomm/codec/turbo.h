@@ -25,6 +25,7 @@
 #include "config.h"
 #include "codec_softout.h"
 #include "fsm.h"
+#include "fsm/cached_fsm.h"
 #include "interleaver.h"
 #include "safe_bcjr.h"
 #include "itfunc.h"
@@ -107,6 +108,7 @@ private:
    bool circular; //!< Flag to indicate trellis tailbiting
    // @}
    /*! \name Internal object representation */
+   boost::shared_ptr<cached_fsm> table; //!< Table-driven encoder (if state table is small enough)
    safe_bcjr<real, dbl> BCJR; //!< BCJR algorithm implementation
    bool initialised; //!< Flag to indicate when memory is initialised
    array2d_t rp; //!< A priori intrinsic source statistics (natural)
@@ -125,6 +127,8 @@ private:
          array2d_t& re);
    void decode_serial(array2d_t& ri);
    void decode_parallel(array2d_t& ri);
+   // encoding functions
+   void do_encode_table(const array1i_t& source, array1i_t& encoded);
    // @}
 protected:
    /*! \name Internal functions */
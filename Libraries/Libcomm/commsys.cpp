@@ -20,6 +20,7 @@
  */
 
 #include "commsys.h"
+#include "modem/batch_modulator.h"
 
 #include "mapper/map_straight.h"
 #include "fsm.h"
@@ -214,6 +215,43 @@ void basic_commsys<S, C>::receive_path(const C<S>& received)
    softreceive_path(ptable_mapped);
    }
 
+/*!
+ * \brief Start a batch of frames, if supported
+ * \return True if frames encoded from now on can be demodulated together
+ *
+ * Batches are possible when the modem supports batch demodulation, and the
+ * receive path demodulates each frame once before decoding.
+ */
+template <class S, template <class > class C>
+bool basic_commsys<S, C>::begin_batch()
+   {
+   batch_modulator<S, C>* m =
+         dynamic_cast<batch_modulator<S, C>*>(this->mdm.get());
+   if (!m)
+      return false;
+   m->begin_batch();
+   return true;
+   }
+
+/*!
+ * \brief Demodulate a batch of frames
+ * \param[in]  received      Received sequences, in the order frames were
+ *                           encoded since begin_batch()
+ * \param[out] ptable_mapped Modem output likelihood tables, one per frame
+ *
+ * The receive path for each frame is then completed with softreceive_path().
+ */
+template <class S, template <class > class C>
+void basic_commsys<S, C>::demodulate_batch(
+      const libbase::vector<C<S> >& received,
+      libbase::vector<C<array1d_t> >& ptable_mapped)
+   {
+   batch_modulator<S, C>& m = dynamic_cast<batch_modulator<S, C>&>(*this->mdm);
+   this->mdm->reset_timers();
+   m.demodulate_batch(*this->rxchan, received, ptable_mapped);
+   this->add_timers(*this->mdm);
+   }
+
 /*!
  * The after-demodulation receive path consists of the steps depicted in the
  * following diagram:
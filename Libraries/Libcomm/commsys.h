@@ -120,6 +120,11 @@ public:
    virtual void receive_path(const C<S>& received);
    //! Perform after-demodulation receive path, except for final decoding
    virtual void softreceive_path(const C<array1d_t>& ptable_mapped);
+   //! Start a batch of frames, if supported
+   virtual bool begin_batch();
+   //! Demodulate a batch of frames
+   virtual void demodulate_batch(const libbase::vector<C<S> >& received,
+         libbase::vector<C<array1d_t> >& ptable_mapped);
    //! Perform a decoding iteration, with hard decision
    virtual void decode(C<int>& decoded);
    // @}
@@ -79,6 +79,11 @@ public:
    // Communication System Interface
    void receive_path(const C<S>& received);
    void decode(C<int>& decoded);
+   //! Frames cannot be batched, as they are demodulated again when decoding
+   bool begin_batch()
+      {
+      return false;
+      }
    // Informative functions
    int num_iter() const
       {
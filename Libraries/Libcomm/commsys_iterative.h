@@ -56,6 +56,11 @@ private:
 public:
    // Communication System Interface
    void receive_path(const C<S>& received);
+   //! Frames cannot be batched, as demodulation is iterated for each frame
+   bool begin_batch()
+      {
+      return false;
+      }
 
    // Description
    std::string description() const;
@@ -60,6 +60,32 @@ const S ssis<S, matrix, dbl>::embed(const int data, const S host, const dbl u,
    return host + S(gtilde * A);
    }
 
+/*!
+ * \brief Determine embedded offsets for each symbol in current block
+ *
+ * The stego-value is the host value plus an offset that depends only on the
+ * data symbol and the uniform sequence; these are computed once per block
+ * and shared by the embedding and extraction processes.
+ */
+template <class S, class dbl>
+void ssis<S, matrix, dbl>::compute_offsets() const
+   {
+   if (offset_valid)
+      return;
+   // Inherit sizes
+   const int rows = this->input_block_size().rows();
+   const int cols = this->input_block_size().cols();
+   const int M = this->num_symbols();
+   // Compute embedded offsets
+   libbase::allocate(offset, M, rows, cols);
+#pragma omp parallel for schedule(static)
+   for (int i = 0; i < rows; i++)
+      for (int j = 0; j < cols; j++)
+         for (int x = 0; x < M; x++)
+            offset(x)(i, j) = embed(x, 0, u(i, j), A);
+   offset_valid = true;
+   }
+
 // Block modem operations
 
 template <class S, class dbl>
@@ -73,6 +99,7 @@ void ssis<S, matrix, dbl>::advance() const
    for (int i = 0; i < rows; i++)
       for (int j = 0; j < cols; j++)
          u(i, j) = r.fval_halfopen();
+   offset_valid = false;
 #ifndef NDEBUG
    frame++;
    libbase::trace << "DEBUG (ssis): Advanced to frame " << frame << std::endl;
@@ -120,9 +147,10 @@ void ssis<S, matrix, dbl>::doembed(const int N, const matrix<int>& data,
    // Initialize results matrix
    tx.init(this->input_block_size());
    // Modulate encoded stream
+   compute_offsets();
    for (int i = 0; i < rows; i++)
       for (int j = 0; j < cols; j++)
-         tx(i, j) = embed(data(i, j), pp_host(i, j), u(i, j), A);
+         tx(i, j) = pp_host(i, j) + offset(data(i, j))(i, j);
    }
 
 template <class S, class dbl>
@@ -136,27 +164,26 @@ void ssis<S, matrix, dbl>::doextract(const channel<S, matrix>& chan,
    const int cols = this->input_block_size().cols();
    const int M = this->num_symbols();
    // Estimate embedded message with ATM filter
-   matrix<S> est(rx.size());
    const int d = 1;
    const int alpha = 1;
    libimage::atmfilter<S> filter(d, alpha);
    filter.apply(rx, est);
-   est = rx - est;
-   // Allocate space for temporary results
-   matrix<vector<double> > ptable_double;
-      {
-      // Create a set of all possible transmitted symbols, at each timestep
-      matrix<vector<S> > tx;
-      libbase::allocate(tx, rows, cols, M);
-      for (int i = 0; i < rows; i++)
-         for (int j = 0; j < cols; j++)
-            for (int x = 0; x < M; x++)
-               tx(i, j)(x) = embed(x, 0, u(i, j), A);
-      // Work out the probabilities of each possible signal
-      chan.receive(tx, est, ptable_double);
-      }
-   // Convert result
-   ptable = ptable_double;
+   // Work out the probabilities of each possible signal, directly from the
+   // embedded offsets
+   compute_offsets();
+   libbase::allocate(ptable, rows, cols, M);
+#pragma omp parallel
+   {
+   vector<S> tx(M);
+#pragma omp for schedule(static)
+   for (int i = 0; i < rows; i++)
+      for (int j = 0; j < cols; j++)
+         {
+         for (int x = 0; x < M; x++)
+            tx(x) = offset(x)(i, j);
+         chan.receive(tx, S(rx(i, j) - est(i, j)), ptable(i, j));
+         }
+   }
    }
 
 // Description
@@ -211,6 +238,7 @@ std::istream& ssis<S, matrix, dbl>::serialize(std::istream& sin)
    sin >> libbase::eatcomments >> temp >> libbase::verify;
    assertalways(temp >=0 && temp < PP_UNDEFINED);
    preprocess = static_cast<pp_enum> (temp);
+   offset_valid = false;
    return sin;
    }
 
@@ -69,6 +69,10 @@ private:
    /*! \name Internal representation */
    mutable libbase::randgen r; //!< Uniform sequence generator
    mutable libbase::matrix<dbl> u; //!< Uniform sequence for current block
+   //! Embedded offset for each symbol, for current block (if computed)
+   mutable libbase::vector<libbase::matrix<S> > offset;
+   mutable bool offset_valid; //!< Flag indicating offsets are for this block
+   libbase::matrix<S> est; //!< Workspace for estimated embedded message
 #ifndef NDEBUG
    mutable int frame; //!< Frame counter since seeding
 #endif
@@ -85,6 +89,8 @@ protected:
     * \return  Stego-value, encoding the given data
     */
    static const S embed(const int data, const S host, const dbl u, const dbl A);
+   //! Determine embedded offsets for each symbol in current block
+   void compute_offsets() const;
    /*!
     * \brief Extract a single symbol
     * \param   rx Received (possibly corrupted) stego-value
@@ -99,6 +105,13 @@ protected:
    void doextract(const channel<S, libbase::matrix>& chan,
          const libbase::matrix<S>& rx, libbase::matrix<array1d_t>& ptable);
 public:
+   /*! \name Constructors / Destructors */
+   ssis() :
+      offset_valid(false)
+      {
+      }
+   // @}
+
    // Setup functions
    void seedfrom(libbase::random& r)
       {
@@ -0,0 +1,178 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "commsys_multithreshold.h"
+
+#include <sstream>
+
+namespace libcomm {
+
+// Experiment handling
+
+/*!
+ * \brief Perform one encode->transmit cycle and a receive cycle per threshold
+ * \param[out] result   Vector containing the set of results to be updated
+ *
+ * Results are organized according to the collector used, as a function of
+ * the iteration count, for each threshold value in turn.
+ */
+template <class S, class R>
+void commsys_multithreshold<S, R>::sample(array1d_t& result)
+   {
+   // Reset timers
+   this->reset_timers();
+   // Initialise result vector
+   result.init(count());
+   result = 0;
+   // Get access to the modem parameter
+   parametric& m = dynamic_cast<parametric&> (*this->sys->getmodem());
+
+   // Create source stream
+   libbase::vector<int> source = this->src->generate_sequence(
+         this->sys->input_block_size());
+   // Encode -> Map -> Modulate
+   libbase::vector<S> transmitted = this->sys->encode_path(source);
+   // Transmit
+   libbase::vector<S> received = this->sys->transmit(transmitted);
+   // For every threshold value
+   libbase::vector<int> decoded;
+   for (int k = 0; k < thresholds.size(); k++)
+      {
+      m.set_parameter(thresholds(k));
+      // Demodulate -> Inverse Map -> Translate
+      this->sys->receive_path(received);
+      // For every iteration
+      for (int i = 0; i < this->sys->num_iter(); i++)
+         {
+         // Decode & update results
+         this->sys->decode(decoded);
+         libbase::indirect_vector<double> result_segment = result.segment(
+               Base::count() * k + R::count() * i, R::count());
+         R::updateresults(result_segment, source, decoded);
+         }
+      }
+
+   // Keep record of what we last simulated (for the last threshold value)
+   const int tau = this->sys->input_block_size();
+   assert(source.size() == tau);
+   assert(decoded.size() == tau);
+   this->last_event.init(2 * tau);
+   for (int i = 0; i < tau; i++)
+      {
+      this->last_event(i) = source(i);
+      this->last_event(i + tau) = decoded(i);
+      }
+   }
+
+// Description & Serialization
+
+template <class S, class R>
+std::string commsys_multithreshold<S, R>::description() const
+   {
+   std::ostringstream sout;
+   sout << "Multiple-modem-threshold (";
+   for (int k = 0; k < thresholds.size(); k++)
+      sout << (k > 0 ? ", " : "") << thresholds(k);
+   sout << ") ";
+   sout << Base::description();
+   return sout.str();
+   }
+
+template <class S, class R>
+std::ostream& commsys_multithreshold<S, R>::serialize(std::ostream& sout) const
+   {
+   sout << "# Number of modem threshold values" << std::endl;
+   sout << thresholds.size() << std::endl;
+   sout << "# Modem threshold values" << std::endl;
+   thresholds.serialize(sout);
+   Base::serialize(sout);
+   return sout;
+   }
+
+template <class S, class R>
+std::istream& commsys_multithreshold<S, R>::serialize(std::istream& sin)
+   {
+   int n;
+   sin >> libbase::eatcomments >> n >> libbase::verify;
+   assertalways(n >= 1);
+   thresholds.init(n);
+   sin >> libbase::eatcomments;
+   thresholds.serialize(sin);
+   libbase::verify(sin);
+   Base::serialize(sin);
+   return sin;
+   }
+
+} // end namespace
+
+#include "gf.h"
+#include "result_collector/commsys/errors_hamming.h"
+#include "result_collector/commsys/errors_levenshtein.h"
+#include "result_collector/commsys/prof_burst.h"
+#include "result_collector/commsys/prof_pos.h"
+#include "result_collector/commsys/prof_sym.h"
+#include "result_collector/commsys/hist_symerr.h"
+
+namespace libcomm {
+
+// Explicit Realizations
+#include <boost/preprocessor/seq/for_each.hpp>
+#include <boost/preprocessor/seq/for_each_product.hpp>
+#include <boost/preprocessor/seq/enum.hpp>
+#include <boost/preprocessor/stringize.hpp>
+
+using libbase::serializer;
+
+#define USING_GF(r, x, type) \
+      using libbase::type;
+
+BOOST_PP_SEQ_FOR_EACH(USING_GF, x, GF_TYPE_SEQ)
+
+// *** General Communication System ***
+
+#define SYMBOL_TYPE_SEQ \
+   (sigspace)(bool) \
+   GF_TYPE_SEQ
+#define COLLECTOR_TYPE_SEQ \
+   (errors_hamming) \
+   (errors_levenshtein) \
+   (prof_burst) \
+   (prof_pos) \
+   (prof_sym) \
+   (hist_symerr)
+
+/* Serialization string: commsys_multithreshold<type,collector>
+ * where:
+ *      type = sigspace | bool | gf2 | gf4 ...
+ *      collector = errors_hamming | errors_levenshtein | ...
+ */
+#define INSTANTIATE(r, args) \
+      template class commsys_multithreshold<BOOST_PP_SEQ_ENUM(args)>; \
+      template <> \
+      const serializer commsys_multithreshold<BOOST_PP_SEQ_ENUM(args)>::shelper( \
+            "experiment", \
+            "commsys_multithreshold<" BOOST_PP_STRINGIZE(BOOST_PP_SEQ_ELEM(0,args)) "," \
+            BOOST_PP_STRINGIZE(BOOST_PP_SEQ_ELEM(1,args)) ">", \
+            commsys_multithreshold<BOOST_PP_SEQ_ENUM(args)>::create); \
+
+BOOST_PP_SEQ_FOR_EACH_PRODUCT(INSTANTIATE, (SYMBOL_TYPE_SEQ)(COLLECTOR_TYPE_SEQ))
+
+} // end namespace
@@ -0,0 +1,99 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __commsys_multithreshold_h
+#define __commsys_multithreshold_h
+
+#include "config.h"
+#include "commsys_simulator.h"
+
+namespace libcomm {
+
+/*!
+ * \brief   Communication System Simulator - Multiple modem thresholds.
+ * \author  Johann Briffa
+ *
+ * A variation on the regular commsys_simulator object, where each sample
+ * evaluates a fixed set of modem threshold values on the same transmitted
+ * frame. The source sequence is generated, encoded and transmitted only once
+ * per sample; the received sequence is then demodulated and decoded once for
+ * each threshold value. This reduces the cost of encoding and transmission
+ * by the number of thresholds, and since all settings see the same channel
+ * realization (common random numbers), comparisons between settings have a
+ * lower variance than with separate simulations.
+ *
+ * Results for each threshold value are organized as in commsys_simulator
+ * (i.e. by iteration count), one after the other in the order given. The
+ * experiment parameter is the channel parameter, as in commsys_simulator.
+ *
+ * \note Results for different iteration counts are already obtained from a
+ * single decoding in commsys_simulator, so there is no need to list these.
+ *
+ * \todo Remove assumption of a parametric modem.
+ */
+template <class S, class R>
+class commsys_multithreshold : public commsys_simulator<S, R> {
+private:
+   // Shorthand for class hierarchy
+   typedef commsys_multithreshold<S, R> This;
+   typedef commsys_simulator<S, R> Base;
+
+public:
+   /*! \name Type definitions */
+   typedef libbase::vector<double> array1d_t;
+   // @}
+
+private:
+   /*! \name User-defined parameters */
+   array1d_t thresholds; //!< Set of modem threshold values to evaluate
+   // @}
+
+public:
+   // Experiment handling
+   void sample(array1d_t& result);
+   int count() const
+      {
+      return Base::count() * thresholds.size();
+      }
+   int get_multiplicity(int i) const
+      {
+      assert(i >= 0 && i < count());
+      return Base::get_multiplicity(i % Base::count());
+      }
+   std::string result_description(int i) const
+      {
+      assert(i >= 0 && i < count());
+      const int k = i / Base::count();
+      std::ostringstream sout;
+      sout << Base::result_description(i % Base::count()) << "_t" << k;
+      return sout.str();
+      }
+
+   // Description
+   std::string description() const;
+
+   // Serialization Support
+DECLARE_SERIALIZER(commsys_multithreshold)
+};
+
+} // end namespace
+
+#endif
@@ -31,6 +31,7 @@
 
 #include "fsm.h"
 #include "itfunc.h"
+#include "memory_pool.h"
 #include "secant.h"
 #include "timer.h"
 #include <iostream>
@@ -41,6 +42,7 @@ namespace libcomm {
 // Determine debug level:
 // 1 - Normal debug output only
 // 2 - For fidelity collector, observe actual/estimated boundary drifts
+// 3 - Report memory allocations for each sample
 #ifndef NDEBUG
 #  undef DEBUG
 #  define DEBUG 1
@@ -60,17 +62,51 @@ namespace libcomm {
  * \note The results collector assumes that the result vector is an accumulator,
  * so that every call adds to the existing result. This explains the need to
  * initialize the result vector to zero.
+ *
+ * \note Temporaries are allocated from the thread's memory pool, so that
+ * blocks released by one sample are reused by the next.
  */
 template <class S, class R>
 void commsys_simulator<S, R>::sample(libbase::vector<double>& result)
    {
+   libbase::memory_pool::scope pool;
+   sample_pooled(result);
+#if DEBUG>=3
+   std::cerr << "DEBUG (commsys_simulator): " << pool.allocations()
+         << " allocations, " << pool.reused() << " from pool" << std::endl;
+#endif
+   }
+
+/*!
+ * \brief Perform a complete encode->transmit->receive cycle, within a memory
+ * pool scope
+ * \param[out] result   Vector containing the set of results to be updated
+ */
+template <class S, class R>
+void commsys_simulator<S, R>::sample_pooled(libbase::vector<double>& result)
+   {
+   // Get access to the results collector in codeword boundary analysis mode
+   fidelity_pos* rc = dynamic_cast<fidelity_pos*>(this);
+   // Use batch path if requested (and not in boundary analysis mode)
+   if (batch_size > 1 && !rc)
+      {
+      // simulate a new batch if we used up the last one
+      if (batch_next >= batch_result.size())
+         sample_batch();
+      // batch simulation is not supported by this system
+      if (batch_result.size() > 0)
+         {
+         result = batch_result(batch_next);
+         last_event = batch_event(batch_next);
+         batch_next++;
+         return;
+         }
+      }
    // Reset timers
    this->reset_timers();
    // Initialise result vector
    result.init(count());
    result = 0;
-   // Get access to the results collector in codeword boundary analysis mode
-   fidelity_pos* rc = dynamic_cast<fidelity_pos*>(this);
 
    // Create source stream
    libbase::vector<int> source = src->generate_sequence(sys->input_block_size());
@@ -140,6 +176,73 @@ void commsys_simulator<S, R>::sample(libbase::vector<double>& result)
       }
    }
 
+/*!
+ * \brief Perform encode->transmit->receive cycles for a batch of frames
+ *
+ * All frames in the batch are encoded and transmitted first, and then
+ * demodulated together; the receive path and decoding is then completed for
+ * each frame in turn. Results and events for each frame are kept, to be
+ * returned by subsequent calls to sample(). Timers are reset only when a new
+ * batch is simulated, and therefore cover the whole batch.
+ *
+ * If the system does not support batch demodulation, no frames are simulated
+ * and the batch is left empty.
+ */
+template <class S, class R>
+void commsys_simulator<S, R>::sample_batch()
+   {
+   discard_batch();
+   // Start a batch, if the system supports it
+   if (!sys->begin_batch())
+      return;
+   // Reset timers
+   this->reset_timers();
+   // Create source streams, and encode and transmit each frame
+   libbase::vector<array1i_t> source(batch_size);
+   libbase::vector<libbase::vector<S> > received(batch_size);
+   for (int k = 0; k < batch_size; k++)
+      {
+      source(k) = src->generate_sequence(sys->input_block_size());
+      received(k) = sys->transmit(sys->encode_path(source(k)));
+      }
+   // Demodulate all frames together
+   libbase::vector<array1vd_t> ptable_mapped;
+   sys->demodulate_batch(received, ptable_mapped);
+   // Complete receive path and decode each frame
+   batch_result.init(batch_size);
+   batch_event.init(batch_size);
+   for (int k = 0; k < batch_size; k++)
+      {
+      // Inverse Map -> Translate
+      sys->softreceive_path(ptable_mapped(k));
+      // Initialise result vector
+      array1d_t& result = batch_result(k);
+      result.init(count());
+      result = 0;
+      // For every iteration
+      libbase::vector<int> decoded;
+      for (int i = 0; i < sys->num_iter(); i++)
+         {
+         // Decode & update results
+         sys->decode(decoded);
+         libbase::indirect_vector<double> result_segment = result.segment(
+               R::count() * i, R::count());
+         R::updateresults(result_segment, source(k), decoded);
+         }
+      // Keep record of what we simulated
+      const int tau = sys->input_block_size();
+      assert(source(k).size() == tau);
+      assert(decoded.size() == tau);
+      array1i_t& event = batch_event(k);
+      event.init(2 * tau);
+      for (int i = 0; i < tau; i++)
+         {
+         event(i) = source(k)(i);
+         event(i + tau) = decoded(i);
+         }
+      }
+   }
+
 // Description & Serialization
 
 template <class S, class R>
@@ -160,11 +263,13 @@ std::ostream& commsys_simulator<S, R>::serialize(std::ostream& sout) const
    {
    // format version
    sout << "# Version" << std::endl;
-   sout << 3 << std::endl;
+   sout << 4 << std::endl;
    sout << "# Source generator" << std::endl;
    sout << src;
    sout << "# Communication system" << std::endl;
    sout << sys;
+   sout << "# Batch size (frames simulated together, if supported)" << std::endl;
+   sout << batch_size << std::endl;
    return sout;
    }
 
@@ -178,6 +283,8 @@ std::ostream& commsys_simulator<S, R>::serialize(std::ostream& sout) const
  * \version 2 Added support for user-supplied sequence of input symbols
  *
  * \version 3 Using source-generator object
+ *
+ * \version 4 Added batch size
  */
 
 template <class S, class R>
@@ -256,6 +363,14 @@ std::istream& commsys_simulator<S, R>::serialize(std::istream& sin)
    // create source generator if not done yet
    if (!src)
       src.reset(new uniform<int>(sys->num_inputs()));
+   // batch size
+   batch_size = 1;
+   if (version >= 4)
+      {
+      sin >> libbase::eatcomments >> batch_size >> libbase::verify;
+      assertalways(batch_size >= 1);
+      }
+   discard_batch();
    // finish
    assertalways(sin.good());
    return sin;
@@ -56,8 +56,14 @@ protected:
    boost::shared_ptr<source<int> > src; //!< Source data sequence generator
    boost::shared_ptr<commsys<S> > sys; //!< Communication systems
    // @}
+   /*! \name User-defined parameters */
+   int batch_size; //!< Number of frames to simulate together, if supported
+   // @}
    /*! \name Internal state */
    array1i_t last_event;
+   libbase::vector<array1d_t> batch_result; //!< Results for frames in current batch
+   libbase::vector<array1i_t> batch_event; //!< Events for frames in current batch
+   int batch_next; //!< Index of next frame to use from current batch
    // @}
 
 protected:
@@ -74,6 +80,17 @@ protected:
       {
       return sys->num_inputs();
       }
+   // Single sample, within a memory pool scope
+   void sample_pooled(libbase::vector<double>& result);
+   // Batch simulation
+   void sample_batch();
+   //! Discard any frames left in the current batch
+   void discard_batch()
+      {
+      batch_result.init(0);
+      batch_event.init(0);
+      batch_next = 0;
+      }
 
 public:
    /*! \name Constructors / Destructors */
@@ -84,10 +101,12 @@ public:
     */
    commsys_simulator(const commsys_simulator<S, R>& c) :
          src(boost::dynamic_pointer_cast<source<int> >(c.src->clone())), sys(
-               boost::dynamic_pointer_cast<commsys<S> >(c.sys->clone()))
+               boost::dynamic_pointer_cast<commsys<S> >(c.sys->clone())), batch_size(
+               c.batch_size), batch_next(0)
       {
       }
-   commsys_simulator()
+   commsys_simulator() :
+         batch_size(1), batch_next(0)
       {
       }
    virtual ~commsys_simulator()
@@ -98,11 +117,13 @@ public:
    // Experiment parameter handling
    void seedfrom(libbase::random& r)
       {
+      discard_batch();
       src->seedfrom(r);
       sys->seedfrom(r);
       }
    void set_parameter(const double x)
       {
+      discard_batch();
       sys->gettxchan()->set_parameter(x);
       sys->getrxchan()->set_parameter(x);
       }
@@ -30,6 +30,7 @@ namespace libcomm {
 template <class S, class R>
 void commsys_threshold<S, R>::set_parameter(const double x)
    {
+   this->discard_batch();
    parametric& m = dynamic_cast<parametric&> (*this->sys->getmodem());
    m.set_parameter(x);
    }
@@ -52,6 +52,7 @@ void cached_fsm::init(fsm& encoder)
    lut_m.init(M, K);
    lut_X.init(M, K);
    lut_Xv.init(M, K);
+   lut_Xs.init(M * K * n);
    for (int mdash = 0; mdash < M; mdash++)
       for (int i = 0; i < K; i++)
          {
@@ -63,6 +64,8 @@ void cached_fsm::init(fsm& encoder)
          assert(lut_Xv(mdash, i).size() == n);
          lut_X(mdash, i) = encoder.convert_output(output);
          assert(lut_X(mdash, i) >= 0 && lut_X(mdash, i) < N);
+         for (int j = 0; j < n; j++)
+            lut_Xs((mdash * K + i) * n + j) = output(j);
          lut_m(mdash, i) = encoder.convert_state(encoder.state());
          assert(lut_m(mdash, i) >= 0 && lut_m(mdash, i) < M);
          }
@@ -71,6 +74,85 @@ void cached_fsm::init(fsm& encoder)
    reset();
    }
 
+// Compiled encoding
+
+/*!
+ * \brief Advance over a sequence, starting from the present state
+ * \param[in] source Input symbols, 'k' for each time-step
+ * \param[in] tau Number of time-steps
+ *
+ * \note This won't work with tail inputs
+ */
+void cached_fsm::advance(const int* source, const int tau)
+   {
+   for (int t = 0; t < tau; t++, source += k)
+      {
+      int i = 0;
+      for (int j = k - 1; j >= 0; j--)
+         {
+         assert(source[j] >= 0 && source[j] < q);
+         i = i * q + source[j];
+         }
+      ps = lut_m(ps, i);
+      }
+   }
+
+/*!
+ * \brief Encode a sequence, starting from the present state
+ * \param[in,out] source Input symbols, 'k' for each time-step; any 'tail'
+ *                 inputs are replaced by the input actually used
+ * \param[in] tau Number of time-steps
+ * \param[out] encoded Output symbols; for time-step 't', outputs 'first' to
+ *                 'first+count-1' are written from position 't*stride'
+ * \param[in] stride Distance between outputs for successive time-steps
+ * \param[in] first Index of first output to write
+ * \param[in] count Number of outputs to write
+ * \param tailer FSM from which this was constructed, used to determine the
+ *                 inputs for tailing out
+ *
+ * This gives the same result as a sequence of step() calls, but works
+ * directly on integer arrays and only makes use of the state table, except
+ * for tail time-steps.
+ */
+void cached_fsm::encode(int* source, const int tau, int* encoded,
+      const int stride, const int first, const int count, fsm& tailer)
+   {
+   assert(first >= 0 && count >= 0 && first + count <= n);
+   const int K = lut_m.size().cols();
+   for (int t = 0; t < tau; t++, source += k, encoded += stride)
+      {
+      // convert input
+      int i = 0;
+      bool tailing = false;
+      for (int j = k - 1; j >= 0; j--)
+         {
+         tailing |= (source[j] == fsm::tail);
+         i = i * q + source[j];
+         }
+      // determine input to use when tailing out
+      if (tailing)
+         {
+         tailer.reset(fsm::convert_state(ps));
+         array1i_t ip(k);
+         for (int j = 0; j < k; j++)
+            ip(j) = source[j];
+         tailer.advance(ip);
+         i = 0;
+         for (int j = k - 1; j >= 0; j--)
+            {
+            source[j] = ip(j);
+            i = i * q + source[j];
+            }
+         }
+      assert(i >= 0 && i < K);
+      // copy outputs and advance
+      const int* x = &lut_Xs((ps * K + i) * n + first);
+      for (int j = 0; j < count; j++)
+         encoded[j] = x[j];
+      ps = lut_m(ps, i);
+      }
+   }
+
 // Serialization
 
 std::ostream& cached_fsm::serialize(std::ostream& sout) const
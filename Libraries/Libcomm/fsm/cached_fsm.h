@@ -47,6 +47,9 @@ namespace libcomm {
  * obtaining the state table. Construction is expensive, but state operations
  * are very fast.
  *
+ * Besides the usual vector interface, whole sequences can be encoded
+ * directly from and to integer arrays, without any per-step allocation.
+ *
  * \todo Fix class serialization and descriptions
  */
 
@@ -79,6 +82,8 @@ private:
    array2i_t lut_m;
    //! lut_Xv(m,i) = encoder output (as vector), given state 'm' and input 'i'
    array2vi_t lut_Xv;
+   //! lut_Xs((m*K+i)*n+j) = encoder output symbol 'j', given state 'm' and input 'i'
+   array1i_t lut_Xs;
    // @}
 
 protected:
@@ -154,6 +159,22 @@ public:
       return op;
       }
 
+   /*! \name Compiled encoding */
+   //! Present state, in integer representation
+   int packed_state() const
+      {
+      return ps;
+      }
+   //! Reset to a specified state, in integer representation
+   void reset_packed(int state)
+      {
+      ps = state;
+      }
+   void advance(const int* source, const int tau);
+   void encode(int* source, const int tau, int* encoded, const int stride,
+         const int first, const int count, fsm& tailer);
+   // @}
+
    // FSM information functions - fundamental
    //! Memory order (length of tail)
    int mem_order() const
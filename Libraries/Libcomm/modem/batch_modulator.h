@@ -0,0 +1,83 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __batch_modulator_h
+#define __batch_modulator_h
+
+#include "channel.h"
+#include "vector.h"
+
+namespace libcomm {
+
+/*!
+ * \brief   Batch Modulator Interface.
+ * \author  Johann Briffa
+ *
+ * Defines an interface for blockmodem classes that can demodulate a number of
+ * independent frames together, for better throughput. This is useful in
+ * simulations, where the latency of individual frames does not matter.
+ *
+ * A batch is started with begin_batch(); the frames in the batch are then
+ * modulated in the usual way, and finally demodulated together with
+ * demodulate_batch(). Modulators with time-varying state need to keep
+ * whatever is necessary to demodulate each frame in the batch.
+ */
+
+template <class S, template <class > class C = libbase::vector>
+class batch_modulator {
+public:
+   /*! \name Type definitions */
+   typedef libbase::vector<double> array1d_t;
+   // @}
+public:
+   /*! \name Constructors / Destructors */
+   virtual ~batch_modulator()
+      {
+      }
+   // @}
+
+   /*! \name Block modem operations - batch extensions */
+   /*!
+    * \brief Start a new batch of frames
+    *
+    * Any frames kept from an earlier batch that was not demodulated are
+    * discarded.
+    */
+   virtual void begin_batch() = 0;
+   /*!
+    * \brief Demodulate all frames in the current batch
+    * \param[in]  chan     The channel model (used to obtain likelihoods)
+    * \param[in]  rx       Sequences of received symbols, one per frame, in the
+    *                      order the frames were modulated
+    * \param[out] ptable   Tables of likelihoods of possible transmitted
+    *                      symbols, one per frame
+    *
+    * This ends the current batch.
+    */
+   virtual void demodulate_batch(const channel<S, C>& chan,
+         const libbase::vector<C<S> >& rx,
+         libbase::vector<C<array1d_t> >& ptable) = 0;
+   // @}
+};
+
+} // end namespace
+
+#endif
@@ -25,6 +25,8 @@
 #include "config.h"
 #include "channel_insdel.h"
 #include <memory>
+#include <vector>
+#include <algorithm>
 
 namespace libcomm {
 
@@ -54,8 +56,11 @@ public:
    typedef libbase::vector<sig> array1s_t;
    typedef libbase::vector<array1s_t> array1vs_t;
    typedef libbase::matrix<array1s_t> array2vs_t;
+   typedef libbase::vector<int> array1i_t;
    typedef libbase::vector<real> array1r_t;
    typedef libbase::vector<real2> array1r2_t;
+   typedef libbase::vector<array1r_t> array1vr_t;
+   typedef libbase::vector<array1r2_t> array1vr2_t;
    typedef libbase::vector<double> array1d_t;
    typedef libbase::vector<array1d_t> array1vd_t;
    // @}
@@ -64,6 +69,34 @@ private:
    mutable array2vs_t encoding_table; //!< Local copy of per-frame encoding table
    std::auto_ptr<typename channel_insdel<sig, real2>::metric_computer> computer; //!< Channel object for computing receiver metric
    // @}
+   /*! \name Internal representation */
+   mutable libbase::vector<array1vs_t> sorted_table; //!< Codewords for each 'i', in lexicographic order
+   mutable libbase::vector<array1i_t> sorted_symbol; //!< Symbol value for each entry in sorted table
+   // @}
+private:
+   /*! \name Internal functions */
+   //! Lexicographic ordering of the codewords for a given index 'i'
+   class codeword_order {
+   private:
+      const array2vs_t& encoding_table;
+      const int i;
+   public:
+      codeword_order(const array2vs_t& encoding_table, const int i) :
+            encoding_table(encoding_table), i(i)
+         {
+         }
+      bool operator()(const int d1, const int d2) const
+         {
+         const array1s_t& a = encoding_table(i, d1);
+         const array1s_t& b = encoding_table(i, d2);
+         const int n = std::min(a.size(), b.size());
+         for (int j = 0; j < n; j++)
+            if (a(j) != b(j))
+               return int(a(j)) < int(b(j));
+         return a.size() < b.size();
+         }
+   };
+   // @}
 public:
    /*! \name User initialization (can be adapted for needs of user class) */
    /*! \brief Set up channel receiver
@@ -90,6 +123,26 @@ public:
    void init(const array2vs_t& encoding_table) const
       {
       this->encoding_table = encoding_table;
+      // Sort codewords for each index, so that common prefixes are adjacent
+      const int N = encoding_table.size().rows();
+      const int q = encoding_table.size().cols();
+      sorted_table.init(N);
+      sorted_symbol.init(N);
+      std::vector<int> order(q);
+      for (int i = 0; i < N; i++)
+         {
+         for (int d = 0; d < q; d++)
+            order[d] = d;
+         std::sort(order.begin(), order.end(),
+               codeword_order(encoding_table, i));
+         sorted_table(i).init(q);
+         sorted_symbol(i).init(q);
+         for (int k = 0; k < q; k++)
+            {
+            sorted_table(i)(k) = encoding_table(i, order[k]);
+            sorted_symbol(i)(k) = order[k];
+            }
+         }
 #if DEBUG>=2
       std::cerr << "Initialize tvb computer..." << std::endl;
       std::cerr << "encoding_table = " << this->encoding_table << std::endl;
@@ -115,6 +168,34 @@ public:
       // convert results
       ptable = ptable_r;
       }
+   /*! \brief Batch receiver interface - all symbol values at once
+    * Results for symbol value 'd' are returned in ptable(d); the result
+    * vectors must be set up by the caller. The codewords are passed to the
+    * metric computer in lexicographic order, allowing it to share computation
+    * between codewords with a common prefix.
+    */
+   void R(int i, const array1s_t& r, const array1vd_t& app,
+         array1vr_t& ptable) const
+      {
+      const int q = sorted_table(i).size();
+      assert(ptable.size() == q);
+      // set up space for results
+      static array1vr2_t ptable_r;
+      ptable_r.init(q);
+      for (int k = 0; k < q; k++)
+         ptable_r(k).init(ptable(0).size());
+      // call batch receiver method
+      computer->receive(sorted_table(i), r, ptable_r);
+      for (int k = 0; k < q; k++)
+         {
+         const int d = sorted_symbol(i)(k);
+         // apply priors at codeword level if applicable
+         if (app.size() > 0)
+            ptable_r(k) *= real2(app(i)(d));
+         // convert results
+         ptable(d) = ptable_r(k);
+         }
+      }
    // @}
 };
 
@@ -247,6 +247,9 @@ void tvb<sig, real, real2>::domodulate(const int q, const array1i_t& encoded,
       tx.segment(j, n) = encoding_table(i, encoded(i));
       j += n;
       }
+   // Keep encoding table if this frame is part of a batch
+   if (batching)
+      batch_tables.push_back(encoding_table);
 #if DEBUG>=3
    std::cerr << "encoded = " << encoded << std::endl;
    std::cerr << "tx = " << tx << std::endl;
@@ -293,6 +296,69 @@ void tvb<sig, real, real2>::dodemodulate(const channel<sig>& chan,
          eof_post, libbase::size_type<libbase::vector>(-mtau_min));
    }
 
+/*!
+ * \brief Demodulate all frames in the current batch
+ *
+ * Each frame is set up for known start and end, as in the block-mode
+ * dodemodulate(), and decoded with the encoding table it was modulated with.
+ * This is only possible without look-ahead.
+ */
+template <class sig, class real, class real2>
+void tvb<sig, real, real2>::demodulate_batch(const channel<sig>& chan,
+      const libbase::vector<array1s_t>& rx, libbase::vector<array1vd_t>& ptable)
+   {
+   libbase::cputimer t("t_demodulate");
+   // Inherit sizes
+   const int N = this->input_block_size();
+   const int W = rx.size();
+   assertalways(batching && int(batch_tables.size()) == W);
+   assertalways(lookahead == 0);
+   // Initialize for known-start
+   init(chan);
+   // Shorthand for transmitted frame size
+   const int tau = this->output_block_size();
+   // Set up received sequences and drift pdfs for each frame
+   libbase::vector<array2vs_t> tables(W);
+   libbase::vector<array1s_t> r(W);
+   array1vd_t sof_prior(W);
+   array1vd_t eof_prior(W);
+   for (int w = 0; w < W; w++)
+      {
+      tables(w) = batch_tables[w];
+      const int rho = rx(w).size();
+      // Check that rx size is within valid range
+      assertalways(mtau_max >= abs(rho - tau));
+      // Set up start-of-frame drift pdf (drift = 0)
+      sof_prior(w).init(mtau_max - mtau_min + 1);
+      sof_prior(w) = 0;
+      sof_prior(w)(0 - mtau_min) = 1;
+      // Set up end-of-frame drift pdf (drift = rho-tau)
+      eof_prior(w).init(mtau_max - mtau_min + 1);
+      eof_prior(w) = 0;
+      eof_prior(w)(rho - tau - mtau_min) = 1;
+      // Offset rx by -mtau_min and pad to a total size of tau+mtau_max-mtau_min
+      r(w).init(tau + mtau_max - mtau_min);
+      r(w).segment(-mtau_min, rho) = rx(w);
+      }
+   // Call FBA and normalize results
+   const libbase::vector<array1vd_t> app(W); // empty APP tables
+   libbase::vector<array1vr_t> ptable_r;
+   array1vr_t sof_post_r;
+   array1vr_t eof_post_r;
+   fba_ptr->decode_batch(*this, tables, r, sof_prior, eof_prior, app,
+         ptable_r, sof_post_r, eof_post_r, -mtau_min);
+   ptable.init(W);
+   for (int w = 0; w < W; w++)
+      libbase::normalize_results(ptable_r(w).extract(0, N), ptable(w));
+   // The receiver was last set up for a frame within the batch
+   changed_encoding_table = true;
+   // End the batch
+   batching = false;
+   batch_tables.clear();
+   this->mark_as_dirty();
+   this->add_timer(t);
+   }
+
 template <class sig, class real, class real2>
 void tvb<sig, real, real2>::dodemodulate(const channel<sig>& chan,
       const array1s_t& rx, const libbase::size_type<libbase::vector> lookahead,
@@ -429,7 +495,7 @@ void tvb<sig, real, real2>::init(const channel<sig>& chan,
    static bool globalstore = false; // set to avoid compiler warning
    bool last_globalstore = globalstore; // keep track of last setting
    const int required = fba_type::get_memory_required(N, q, mtau_min, mtau_max,
-         mn_min, mn_max);
+         mn_min, mn_max, gamma_format);
    switch (storage_type)
       {
       case storage_local:
@@ -457,6 +523,8 @@ void tvb<sig, real, real2>::init(const channel<sig>& chan,
             || tp_states > 0;
       fba_ptr = fba2_factory<sig, real, real2>::get_instance(fss, thresholding,
             flags.lazy, globalstore);
+      if (globalstore)
+         fba_ptr->set_gamma_format(gamma_format, gamma_threshold);
       // Mark the encoding table as changed, to force receiver init
       changed_encoding_table = true;
       }
@@ -792,6 +860,28 @@ std::string tvb<sig, real, real2>::description() const
          failwith("Unknown storage mode");
          break;
       }
+   if (storage_type != storage_local)
+      {
+      switch (gamma_format)
+         {
+         case fba_type::gamma_format_real:
+            break;
+
+         case fba_type::gamma_format_float:
+            sout << " as float";
+            break;
+
+         case fba_type::gamma_format_log16:
+            sout << " as 16-bit log";
+            break;
+
+         default:
+            failwith("Unknown gamma storage format");
+            break;
+         }
+      if (gamma_threshold > 0)
+         sout << " (zero below " << gamma_threshold << ")";
+      }
    if (lookahead == 0)
       sout << ", no look-ahead";
    else
@@ -810,7 +900,7 @@ template <class sig, class real, class real2>
 std::ostream& tvb<sig, real, real2>::serialize(std::ostream& sout) const
    {
    sout << "# Version" << std::endl;
-   sout << 11 << std::endl;
+   sout << 13 << std::endl;
    sout << "# Inner threshold" << std::endl;
    sout << th_inner << std::endl;
    sout << "# Outer threshold" << std::endl;
@@ -828,6 +918,10 @@ std::ostream& tvb<sig, real, real2>::serialize(std::ostream& sout) const
       sout << "#: Memory threshold for global storage (in MiB)" << std::endl;
       sout << globalstore_limit << std::endl;
       }
+   sout << "# Storage format for gamma in global storage mode (0=real, 1=float, 2=log16)" << std::endl;
+   sout << gamma_format << std::endl;
+   sout << "# Fraction of state maximum below which gamma is stored as zero" << std::endl;
+   sout << gamma_threshold << std::endl;
    sout << "# Number of codewords to look ahead when stream decoding"
          << std::endl;
    sout << lookahead << std::endl;
@@ -917,6 +1011,9 @@ std::ostream& tvb<sig, real, real2>::serialize(std::ostream& sout) const
  *      (use separate codebooks instead)
  *
  * \version 12 Added trellis pruning parameter
+ *
+ * \version 13 Added storage format and sparsification threshold for gamma
+ *      in global storage mode
  */
 
 template <class sig, class real, class real2>
@@ -976,6 +1073,21 @@ std::istream& tvb<sig, real, real2>::serialize(std::istream& sin)
       }
    else
       storage_type = storage_global;
+   // read storage format for gamma
+   if (version >= 13)
+      {
+      sin >> libbase::eatcomments >> temp >> libbase::verify;
+      gamma_format = (typename fba_type::gamma_format_t) temp;
+      assertalways(gamma_format >= fba_type::gamma_format_real
+            && gamma_format < fba_type::gamma_format_undefined);
+      sin >> libbase::eatcomments >> gamma_threshold >> libbase::verify;
+      assertalways(gamma_threshold >= 0 && gamma_threshold < 1);
+      }
+   else
+      {
+      gamma_format = fba_type::gamma_format_real;
+      gamma_threshold = 0;
+      }
    // read look-ahead quantity
    if (version >= 4)
       sin >> libbase::eatcomments >> lookahead >> libbase::verify;
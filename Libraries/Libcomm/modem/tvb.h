@@ -25,6 +25,7 @@
 #include "config.h"
 
 #include "stream_modulator.h"
+#include "batch_modulator.h"
 #include "channel_insdel.h"
 #include "algorithm/fba2-interface.h"
 
@@ -37,6 +38,7 @@
 #include <cstdlib>
 #include <cmath>
 #include <memory>
+#include <vector>
 
 #include "boost/shared_ptr.hpp"
 
@@ -58,7 +60,9 @@ namespace libcomm {
  */
 
 template <class sig, class real, class real2>
-class tvb : public stream_modulator<sig> , public parametric {
+class tvb : public stream_modulator<sig> ,
+      public batch_modulator<sig> ,
+      public parametric {
 public:
    /*! \name Type definitions */
    typedef libbase::vector<int> array1i_t;
@@ -106,6 +110,8 @@ private:
    } flags;
    storage_t storage_type; //!< enum indicating storage mode for gamma metric
    int globalstore_limit; //!< fba memory threshold in MiB for global storage, if applicable
+   typename fba2_interface<sig, real, real2>::gamma_format_t gamma_format; //!< storage format for gamma metric in global storage mode
+   double gamma_threshold; //!< fraction of state maximum below which gamma is stored as zero
    int lookahead; //!< Number of codewords to look ahead when stream decoding
    // @}
    /*! \name Internally-used objects */
@@ -113,6 +119,8 @@ private:
    mutable libbase::randgen r; //!< for construction and random application of codebooks and marker sequence
    mutable array2vs_t encoding_table; //!< per-frame encoding table
    mutable bool changed_encoding_table; //!< flag indicating encoding table has changed since last use
+   bool batching; //!< flag indicating encoding tables are kept for batch demodulation
+   std::vector<array2vs_t> batch_tables; //!< encoding tables for frames in current batch
    int mtau_min; //!< The largest negative drift within a whole frame is \f$ m_\tau^{-} \f$
    int mtau_max; //!< The largest positive drift within a whole frame is \f$ m_\tau^{+} \f$
    typedef fba2_interface<sig, real, real2> fba_type;
@@ -218,7 +226,9 @@ public:
    explicit tvb(const int n = 2, const int q = 2, const double th_inner = 0,
          const double th_outer = 0, const int tp_states = 0) :
          q(q), marker_type(marker_zero), codebook_type(codebook_random), th_inner(
-               real(th_inner)), th_outer(real(th_outer)), tp_states(tp_states)
+               real(th_inner)), th_outer(real(th_outer)), tp_states(tp_states), gamma_format(
+               fba2_interface<sig, real, real2>::gamma_format_real), gamma_threshold(
+               0), batching(false)
       {
       // Initialize space for random codebook
       libbase::allocate(codebook_tables, 1, q, n);
@@ -235,15 +245,17 @@ public:
     *       won't need to clone the RX commsys object in stream simulations.
     */
    tvb(const tvb& x) :
-         stream_modulator<sig>(x), parametric(x), q(x.q), marker_type(
-               x.marker_type), codebook_type(x.codebook_type), codebook_name(
+         stream_modulator<sig>(x), batch_modulator<sig>(x), parametric(x), q(
+               x.q), marker_type(x.marker_type), codebook_type(
+               x.codebook_type), codebook_name(
                x.codebook_name), codebook_tables(x.codebook_tables), th_inner(
                x.th_inner), th_outer(x.th_outer), tp_states(x.tp_states), Pr(
                x.Pr), flags(x.flags), storage_type(x.storage_type), globalstore_limit(
-               x.globalstore_limit), lookahead(x.lookahead), r(x.r), encoding_table(
+               x.globalstore_limit), gamma_format(x.gamma_format), gamma_threshold(
+               x.gamma_threshold), lookahead(x.lookahead), r(x.r), encoding_table(
                x.encoding_table), changed_encoding_table(
-               x.changed_encoding_table), mtau_min(x.mtau_min), mtau_max(
-               x.mtau_max)
+               x.changed_encoding_table), batching(x.batching), batch_tables(
+               x.batch_tables), mtau_min(x.mtau_min), mtau_max(x.mtau_max)
       {
       if (x.mychan)
          mychan = boost::dynamic_pointer_cast<channel_insdel<sig, real2> > (x.mychan->clone());
@@ -347,6 +359,16 @@ public:
       return Pr;
       }
 
+   // Block modem operations - batch extensions
+   void begin_batch()
+      {
+      batch_tables.clear();
+      batching = true;
+      }
+   void demodulate_batch(const channel<sig>& chan,
+         const libbase::vector<array1s_t>& rx,
+         libbase::vector<array1vd_t>& ptable);
+
    // Description
    std::string description() const;
 
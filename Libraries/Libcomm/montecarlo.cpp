@@ -250,20 +250,112 @@ void montecarlo::display(const libbase::vector<double>& result,
 
 /*!
  * \brief Determine overall estimate from accumulated results
+ * \param[in]  system      Experiment holding the accumulated results
  * \param[out] result      Vector containing the set of estimates
  * \param[out] errormargin Corresponding margin of error (radius of confidence interval)
  */
-void montecarlo::updateresults(vector<double>& result,
-      vector<double>& errormargin) const
+void montecarlo::updateresults(const experiment& system,
+      vector<double>& result, vector<double>& errormargin) const
    {
    const double cfactor = libbase::Qinv((1.0 - confidence) / 2.0);
    // determine a new estimate
-   system->estimate(result, errormargin);
+   system.estimate(result, errormargin);
    assert(result.size() == errormargin.size());
    // determine confidence interval from standard error
    errormargin *= cfactor;
    }
 
+/*!
+ * \brief Check whether accumulated results have converged
+ * \param[in] system      Experiment holding the accumulated results
+ * \param[in] result      Vector containing the set of estimates
+ * \param[in] errormargin Corresponding margin of error
+ *
+ * Results are considered to have converged if we have done enough samples
+ * for the accuracy to be meaningful, and the required accuracy is reached.
+ */
+bool montecarlo::isconverged(const experiment& system,
+      const vector<double>& result, const vector<double>& errormargin) const
+   {
+   if (system.get_samplecount() < libbase::int64u(min_samples))
+      return false;
+   switch (mode)
+      {
+      case mode_relative_error:
+         {
+         // determine error margin as a fraction of result mean
+         const vector<double> result_acc = errormargin / result;
+         // check if this is less than threshold
+         return result_acc.max() <= threshold;
+         }
+      case mode_absolute_error:
+         // check if error margin is less than threshold
+         return errormargin.max() <= threshold;
+      case mode_accumulated_result:
+         {
+         // determine the absolute accumulated result
+         vector<double> result_acc = result;
+         for (int i = 0; i < result_acc.size(); i++)
+            result_acc(i) *= system.get_samplecount(i);
+         // check if this is more than threshold
+         return result_acc.min() >= threshold;
+         }
+      default:
+         failwith("Convergence mode not supported.");
+         break;
+      }
+   return false;
+   }
+
+/*!
+ * \brief Determine how far accumulated results are from convergence
+ * \param[in] system      Experiment holding the accumulated results
+ * \param[in] result      Vector containing the set of estimates
+ * \param[in] errormargin Corresponding margin of error
+ * \return Ratio of current accuracy to target accuracy
+ *
+ * The returned value is at most 1 when the required accuracy is reached;
+ * larger values indicate results that are further from convergence.
+ * Undefined accuracy (e.g. a zero-valued result in relative-error mode)
+ * is considered to be maximally far from convergence.
+ */
+double montecarlo::get_distance(const experiment& system,
+      const vector<double>& result, const vector<double>& errormargin) const
+   {
+   const double dmax = std::numeric_limits<double>::max();
+   const libbase::int64u samplecount = system.get_samplecount();
+   if (samplecount == 0)
+      return dmax;
+   double d = dmax;
+   switch (mode)
+      {
+      case mode_relative_error:
+         d = (errormargin / result).max() / threshold;
+         break;
+      case mode_absolute_error:
+         d = errormargin.max() / threshold;
+         break;
+      case mode_accumulated_result:
+         {
+         vector<double> result_acc = result;
+         for (int i = 0; i < result_acc.size(); i++)
+            result_acc(i) *= system.get_samplecount(i);
+         d = threshold / result_acc.min();
+         break;
+         }
+      default:
+         failwith("Convergence mode not supported.");
+         break;
+      }
+   // catch undefined or infinite values
+   if (!(d < dmax))
+      d = dmax;
+   // account for the minimum number of samples
+   if (samplecount < libbase::int64u(min_samples))
+      d = std::max(d, double(min_samples) / double(samplecount));
+   return d;
+   }
+
 /*!
  * \brief Initialize given slave
  * \param   s              Slave to be initialized
@@ -394,6 +486,169 @@ bool montecarlo::readpendingslaves()
    return results_available;
    }
 
+// Parameter sweep helper functions
+
+/*!
+ * \brief Worker process for a parameter sweep
+ * \param   pset           Set of parameter values in sweep
+ * \param   systemstring   Serialized system description
+ *
+ * Each worker creates its own copy of the system, seeded independently,
+ * and repeatedly asks for a parameter point to work on. The worker samples
+ * that point for a fixed time (as is done by slaves) and returns the
+ * accumulated state to the corresponding point. Parameter values are only
+ * changed when the worker is moved to a different point.
+ */
+void montecarlo::sweep_work(const vector<double>& pset,
+      const std::string& systemstring)
+   {
+   boost::shared_ptr<experiment> local;
+   libbase::int32u localseed = 0;
+#ifdef USE_OMP
+#pragma omp critical(montecarlo_sweep)
+#endif
+      {
+      std::istringstream is(systemstring);
+      is >> local;
+      localseed = sweep_prng.ival();
+      }
+   libbase::randgen prng;
+   prng.seed(localseed);
+   local->seedfrom(prng);
+
+   int current = -1;
+   while (true)
+      {
+      int p;
+#ifdef USE_OMP
+#pragma omp critical(montecarlo_sweep)
+#endif
+      p = sweep_assign(current);
+      if (p < 0)
+         break;
+      if (p != current)
+         local->set_parameter(pset(p));
+      current = p;
+      // Iterate for 500ms, as is done by slaves
+      local->reset();
+      libbase::walltimer tworker("montecarlo_worker");
+      while (tworker.elapsed() < 0.5)
+         sampleandaccumulate(*local);
+      tworker.stop(); // to avoid expiry
+      // Return accumulated results
+      libbase::vector<double> state;
+      local->get_state(state);
+#ifdef USE_OMP
+#pragma omp critical(montecarlo_sweep)
+#endif
+      sweep_collect(p, local->get_samplecount(), state);
+      }
+   }
+
+/*!
+ * \brief Choose the parameter point a worker should sample next
+ * \param   current  Index of point the worker was last sampling (or -1)
+ * \return  Index of point to sample, or -1 if the worker should stop
+ *
+ * The chosen point is the one furthest from convergence, after scaling by
+ * the number of workers already sampling it. On ties, the worker's current
+ * point is preferred, to avoid unnecessary parameter changes.
+ *
+ * \note Must be called within the sweep critical section.
+ */
+int montecarlo::sweep_assign(int current)
+   {
+   if (sweep_stop)
+      return -1;
+   int best = -1;
+   double bestpriority = 0;
+   for (int p = 0; p < int(sweep.size()); p++)
+      {
+      const sweep_point& sp = sweep[p];
+      if (sp.converged || sp.skipped)
+         continue;
+      const double priority = sp.distance / (1 + sp.workers);
+      if (best < 0 || priority > bestpriority
+            || (priority == bestpriority && p == current))
+         {
+         best = p;
+         bestpriority = priority;
+         }
+      }
+   if (best >= 0)
+      sweep[best].workers++;
+   return best;
+   }
+
+/*!
+ * \brief Accumulate results returned by a worker
+ * \param   p              Index of point sampled by the worker
+ * \param   samplecount    Number of samples taken by the worker
+ * \param   state          Accumulated results from the worker
+ *
+ * Results are discarded if the point is no longer needed. Otherwise, the
+ * estimate for the point is updated, and any points that are complete are
+ * written to the results file (in sweep order). When a converged point
+ * satisfies the cut-off condition, any later points are skipped. This is
+ * also where user interrupts are checked for.
+ *
+ * \note Must be called within the sweep critical section.
+ */
+void montecarlo::sweep_collect(int p, libbase::int64u samplecount,
+      const vector<double>& state)
+   {
+   sweep_point& sp = sweep[p];
+   sp.workers--;
+   if (!sp.converged && !sp.skipped)
+      {
+      // accumulate and update estimate for this point
+      sp.system->accumulate_state(samplecount, state);
+      updateresults(*sp.system, sp.result, sp.errormargin);
+      sp.distance = get_distance(*sp.system, sp.result, sp.errormargin);
+      sp.converged = isconverged(*sp.system, sp.result, sp.errormargin);
+      // cut off later points if necessary
+      if (sp.converged && cutoff(sp.result))
+         for (int i = p + 1; i < int(sweep.size()); i++)
+            sweep[i].skipped = true;
+      // print something to inform the user of our progress
+      system = sp.system;
+      display(sp.result, sp.errormargin);
+      }
+   // write results for any completed points, in order
+   while (sweep_written < int(sweep.size()) && (sweep[sweep_written].converged
+         || sweep[sweep_written].skipped))
+      {
+      if (!sweep[sweep_written].skipped)
+         sweep_writeresults(sweep_written, false);
+      sweep_written++;
+      }
+   // stop if all points are done, or if the user has interrupted
+   if (sweep_written == int(sweep.size()) || interrupt())
+      sweep_stop = true;
+   }
+
+/*!
+ * \brief Write results for the given parameter point
+ * \param   p           Index of point to write
+ * \param   savestate   Flag indicating the simulation state should be saved
+ *
+ * Any saved state in the results file for this point is reloaded first,
+ * as in a serial simulation.
+ */
+void montecarlo::sweep_writeresults(int p, bool savestate)
+   {
+   sweep_point& sp = sweep[p];
+   assert(!sp.written);
+   system = sp.system;
+   if (resultsfile::isinitialized())
+      {
+      setupfile();
+      updateresults(sp.result, sp.errormargin);
+      writefinalresults(sp.result, sp.errormargin, savestate);
+      }
+   sp.written = true;
+   }
+
 // Main process
 
 /*!
@@ -457,43 +712,8 @@ void montecarlo::estimate(vector<double>& result, vector<double>& errormargin)
       if (results_available)
          {
          updateresults(result, errormargin);
-         // if we have done enough samples, check accuracy reached
-         if (system->get_samplecount() >= libbase::int64u(min_samples))
-            {
-            switch (mode)
-               {
-               case mode_relative_error:
-                  {
-                  // determine error margin as a fraction of result mean
-                  const vector<double> result_acc = errormargin / result;
-                  // check if this is less than threshold
-                  if (result_acc.max() <= threshold)
-                     converged = true;
-                  break;
-                  }
-               case mode_absolute_error:
-                  {
-                  // check if error margin is less than threshold
-                  if (errormargin.max() <= threshold)
-                     converged = true;
-                  break;
-                  }
-               case mode_accumulated_result:
-                  {
-                  // determine the absolute accumulated result
-                  vector<double> result_acc = result;
-                  for (int i = 0; i < result_acc.size(); i++)
-                     result_acc(i) *= system->get_samplecount(i);
-                  // check if this is more than threshold
-                  if (result_acc.min() >= threshold)
-                     converged = true;
-                  break;
-                  }
-               default:
-                  failwith("Convergence mode not supported.");
-                  break;
-               }
-            }
+         // check if accuracy reached (with enough samples)
+         converged = isconverged(*system, result, errormargin);
          // print something to inform the user of our progress
          display(result, errormargin);
          // write interim results
@@ -513,4 +733,91 @@ void montecarlo::estimate(vector<double>& result, vector<double>& errormargin)
    t.stop();
    }
 
+/*!
+ * \brief Simulate the system over a set of parameter values until convergence
+ * to given accuracy & confidence, and return estimated results
+ * \param[in]  pset         Set of parameter values to simulate
+ * \param[in]  workers      Number of concurrent workers to use
+ * \param[out] results      Vector of results for each parameter value
+ * \param[out] errormargins Vector of corresponding margin of error
+ *
+ * This is equivalent to setting each parameter value in turn and calling
+ * estimate(), except that all parameter values are simulated concurrently.
+ * Parameter values after a converged point for which cutoff() is true are
+ * not simulated, and their results are left empty. An interrupt from the
+ * user stops all points, saving the state of any incomplete points.
+ *
+ * \note Only available in local mode; the number of workers is limited to
+ * one if OpenMP support is not compiled in.
+ */
+void montecarlo::estimate(const vector<double>& pset, int workers,
+      vector<vector<double> >& results, vector<vector<double> >& errormargins)
+   {
+   assertalways(!cluster.isenabled());
+   assertalways(workers >= 1);
+#ifndef USE_OMP
+   if (workers > 1)
+      {
+      std::cerr << "WARNING (montecarlo): no thread support, using one worker"
+            << std::endl;
+      workers = 1;
+      }
+#endif
+   t.start();
+
+   // keep the bound system, to be restored when done
+   boost::shared_ptr<experiment> bound = system;
+   // create string representation of system
+   std::string systemstring = get_systemstring();
+   // compute its digest
+   std::istringstream is(systemstring);
+   sysdigest.process(is);
+
+   // set up an accumulator for each parameter value
+   sweep.assign(pset.size().length(), sweep_point());
+   for (int p = 0; p < pset.size(); p++)
+      {
+      sweep_point& sp = sweep[p];
+      std::istringstream is(systemstring);
+      is >> sp.system;
+      sp.system->set_parameter(pset(p));
+      sp.system->reset();
+      sp.distance = std::numeric_limits<double>::max();
+      sp.workers = 0;
+      sp.converged = false;
+      sp.written = false;
+      sp.skipped = false;
+      }
+   sweep_written = 0;
+   sweep_stop = false;
+   sweep_prng.seed(seed);
+   std::cerr << "Seed: " << seed << std::endl;
+
+   // run workers until all points are done
+#ifdef USE_OMP
+#pragma omp parallel num_threads(workers)
+#endif
+   sweep_work(pset, systemstring);
+
+   // write results for any incomplete points (after an interrupt)
+   for (; sweep_written < int(sweep.size()); sweep_written++)
+      if (!sweep[sweep_written].skipped
+            && sweep[sweep_written].system->get_samplecount() > 0)
+         sweep_writeresults(sweep_written, true);
+
+   // return results
+   results.init(pset.size());
+   errormargins.init(pset.size());
+   for (int p = 0; p < pset.size(); p++)
+      if (!sweep[p].skipped)
+         {
+         results(p) = sweep[p].result;
+         errormargins(p) = sweep[p].errormargin;
+         }
+   sweep.clear();
+   system = bound;
+
+   t.stop();
+   }
+
 } // end namespace
@@ -30,13 +30,24 @@
 #include "masterslave.h"
 #include "resultsfile.h"
 #include "truerand.h"
+#include "randgen.h"
 #include <sstream>
+#include <vector>
 
 namespace libcomm {
 
 /*!
  * \brief   Monte Carlo Estimator.
  * \author  Johann Briffa
+ *
+ * In local mode, a whole parameter sweep may also be estimated at once, with
+ * a number of workers sampling different parameter values concurrently. Each
+ * worker holds its own copy of the system, and returns accumulated results
+ * to the corresponding parameter point in the same way as a slave would.
+ * Idle workers are always assigned to the point furthest from convergence
+ * (taking into account how many workers are already on it), so that fast
+ * points do not leave workers idle while slow points are still running.
+ * Results are written to the results file in sweep order.
  */
 
 class montecarlo : private resultsfile {
@@ -63,6 +74,27 @@ private:
    mutable libbase::walltimer tupdate; //!< timer to keep track of display rate
    sha sysdigest; //!< digest of the currently-simulated system
    // @}
+   /*! \name Parameter sweep state */
+   /*!
+    * \brief State for one parameter value in a concurrent sweep
+    * Each point keeps its own copy of the experiment, which is used only as
+    * an accumulator for results returned by the workers.
+    */
+   struct sweep_point {
+      boost::shared_ptr<experiment> system; //!< Accumulator for this point
+      libbase::vector<double> result; //!< Latest estimate
+      libbase::vector<double> errormargin; //!< Latest margin of error
+      double distance; //!< Distance from convergence (<=1 means converged)
+      int workers; //!< Number of workers currently sampling this point
+      bool converged; //!< Flag indicating the point needs no more samples
+      bool written; //!< Flag indicating results have been written to file
+      bool skipped; //!< Flag indicating the point was cut off by an earlier one
+   };
+   std::vector<sweep_point> sweep; //!< Points in the current sweep
+   int sweep_written; //!< Number of points (in order) dealt with so far
+   bool sweep_stop; //!< Flag indicating workers should stop
+   libbase::randgen sweep_prng; //!< Source of seeds for worker experiments
+   // @}
 private:
    /*! \name Slave process functions */
    void slave_getcode(void);
@@ -78,19 +110,43 @@ private:
    /*!
     * \brief Compute a single sample and accumulate results
     */
-   void sampleandaccumulate()
+   void sampleandaccumulate(experiment& system)
       {
       libbase::vector<double> result;
-      system->sample(result);
-      system->accumulate(result);
+      system.sample(result);
+      system.accumulate(result);
       }
-   void updateresults(libbase::vector<double>& result,
+   void sampleandaccumulate()
+      {
+      sampleandaccumulate(*system);
+      }
+   void updateresults(const experiment& system,
+         libbase::vector<double>& result,
          libbase::vector<double>& errormargin) const;
+   void updateresults(libbase::vector<double>& result,
+         libbase::vector<double>& errormargin) const
+      {
+      updateresults(*system, result, errormargin);
+      }
+   bool isconverged(const experiment& system,
+         const libbase::vector<double>& result,
+         const libbase::vector<double>& errormargin) const;
+   double get_distance(const experiment& system,
+         const libbase::vector<double>& result,
+         const libbase::vector<double>& errormargin) const;
    void initslave(boost::shared_ptr<libbase::socket> s, std::string systemstring);
    void initnewslaves(std::string systemstring);
    void workidleslaves(bool converged);
    bool readpendingslaves();
    // @}
+   /*! \name Parameter sweep helper functions */
+   void sweep_work(const libbase::vector<double>& pset,
+         const std::string& systemstring);
+   int sweep_assign(int current);
+   void sweep_collect(int p, libbase::int64u samplecount,
+         const libbase::vector<double>& state);
+   void sweep_writeresults(int p, bool savestate);
+   // @}
 protected:
    // System-specific file-handler functions
    void writeheader(std::ostream& sout) const;
@@ -117,13 +173,22 @@ protected:
       }
    virtual void display(const libbase::vector<double>& result,
          const libbase::vector<double>& errormargin) const;
+   /*! \brief Sweep cut-off check
+    * In a parameter sweep, this function should return true if the given
+    * (converged) result means that parameter values later in the sweep need
+    * not be simulated. Default action is to never cut off the sweep.
+    */
+   virtual bool cutoff(const libbase::vector<double>& result) const
+      {
+      return false;
+      }
    // @}
 public:
    /*! \name Constructor/destructor */
    montecarlo() :
          min_samples(128), confidence(0.95), threshold(0.10), mode(
                mode_relative_error), t("montecarlo"), tupdate(
-               "montecarlo_update")
+               "montecarlo_update"), sweep_written(0), sweep_stop(false)
       {
       // create functors
       boost::shared_ptr<libbase::functor> fgetcode(
@@ -265,6 +330,9 @@ public:
    /*! \name Main process */
    void estimate(libbase::vector<double>& result,
          libbase::vector<double>& errormargin);
+   void estimate(const libbase::vector<double>& pset, int workers,
+         libbase::vector<libbase::vector<double> >& results,
+         libbase::vector<libbase::vector<double> >& errormargins);
    // @}
 };
 
@@ -121,6 +121,7 @@
 #include "commsys_fulliter.h"
 
 // Experiments
+#include "experiment/binomial/commsys_multithreshold.h"
 #include "experiment/binomial/commsys_simulator.h"
 #include "experiment/binomial/commsys_stream_simulator.h"
 #include "experiment/binomial/commsys_threshold.h"
@@ -230,6 +231,7 @@ private:
    commsys_simulator<bool, errors_hamming> _commsys_simulator;
    commsys_stream_simulator<bool, errors_hamming, float> _commsys_stream_simulator;
    commsys_threshold<bool, errors_hamming> _commsys_threshold;
+   commsys_multithreshold<bool, errors_hamming> _commsys_multithreshold;
    commsys_timer<bool> _commsys_timer;
    exit_computer<bool> _exit_computer;
 public:
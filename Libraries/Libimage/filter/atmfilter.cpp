@@ -20,7 +20,7 @@
  */
 
 #include "atmfilter.h"
-#include <list>
+#include <vector>
 #include <algorithm>
 #include <numeric>
 
@@ -37,6 +37,14 @@ void atmfilter<T>::init(const int d, const int alpha)
 
 // filter process loop (only updates output matrix)
 
+/*!
+ * \brief Apply filter, keeping a sorted neighbourhood as it slides along
+ * each row
+ *
+ * Moving to the next pixel only removes the column leaving the neighbourhood
+ * and inserts the one entering it, rather than sorting the whole
+ * neighbourhood again. Rows are processed in parallel.
+ */
 template <class T>
 void atmfilter<T>::process(const libbase::matrix<T>& in,
       libbase::matrix<T>& out) const
@@ -45,36 +53,44 @@ void atmfilter<T>::process(const libbase::matrix<T>& in,
    const int N = in.size().cols();
 
    out.init(M, N);
-   std::list<T> lst;
 
+#pragma omp parallel
+   {
+   // sorted list of neighbouring pixels
+   std::vector<T> lst;
+   lst.reserve((2 * m_d + 1) * (2 * m_d + 1));
+#pragma omp for schedule(dynamic)
    for (int i = 0; i < M; i++)
       {
       display_progress(i, M);
+      const int i1 = std::max(i - m_d, 0);
+      const int i2 = std::min(i + m_d, M - 1);
+      // set up neighbourhood for the first pixel in this row
+      lst.clear();
+      for (int jj = 0; jj <= std::min(m_d, N - 1); jj++)
+         for (int ii = i1; ii <= i2; ii++)
+            lst.insert(std::upper_bound(lst.begin(), lst.end(), in(ii, jj)),
+                  in(ii, jj));
       for (int j = 0; j < N; j++)
          {
-         // create list of neighbouring pixels
-         lst.clear();
-         for (int ii = std::max(i - m_d, 0); ii <= std::min(i + m_d, M - 1); ii++)
-            for (int jj = std::max(j - m_d, 0); jj <= std::min(j + m_d, N - 1); jj++)
-               lst.push_back(in(ii, jj));
-         // sort the list
-         lst.sort();
-         // erase the first and last alpha elements
-         typename std::list<T>::iterator p1 = lst.begin();
-         typename std::list<T>::iterator p2 = lst.end();
-         for (int k = 0; k < m_alpha; k++)
-            {
-            p1++;
-            p2--;
-            }
+         // update neighbourhood for the current pixel
+         if (j - m_d - 1 >= 0)
+            for (int ii = i1; ii <= i2; ii++)
+               lst.erase(std::lower_bound(lst.begin(), lst.end(), in(ii, j
+                     - m_d - 1)));
+         if (j > 0 && j + m_d < N)
+            for (int ii = i1; ii <= i2; ii++)
+               lst.insert(std::upper_bound(lst.begin(), lst.end(), in(ii, j
+                     + m_d)), in(ii, j + m_d));
          // compute the mean, skipping the first and last alpha elements
          const int n = lst.size() - 2 * m_alpha;
          T d = 0;
-         d = accumulate(p1, p2, d);
+         d = accumulate(lst.begin() + m_alpha, lst.end() - m_alpha, d);
          out(i, j) = d / n;
          }
       }
    }
+   }
 
 // Explicit Realizations
 
@@ -21,102 +21,127 @@
 
 #include "image.h"
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <typeinfo>
+#include <vector>
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
 
 namespace libimage {
 
-// Saving/loading functions
+namespace {
 
+/*!
+ * \brief Conversion between pixel values and file samples
+ *
+ * The general form is used for integer pixel types, which hold file samples
+ * directly; floating-point types are scaled to [0.0,1.0].
+ */
 template <class T>
-std::ostream& image<T>::serialize(std::ostream& sout) const
+struct pixel {
+   static int to_sample(const T x, const int maxval)
+      {
+      return int(x);
+      }
+   static T from_sample(const int p, const int maxval)
+      {
+      return T(p);
+      }
+};
+
+template <class T>
+struct scaled_pixel {
+   static int to_sample(const T x, const int maxval)
+      {
+      return int(round(x * maxval));
+      }
+   static T from_sample(const int p, const int maxval)
+      {
+      return T(p) / T(maxval);
+      }
+};
+
+template <>
+struct pixel<float> : public scaled_pixel<float> {
+};
+
+template <>
+struct pixel<double> : public scaled_pixel<double> {
+};
+
+/*!
+ * \brief Stream buffer over a block of memory, without copying
+ */
+class memory_buffer : public std::streambuf {
+public:
+   memory_buffer(char* begin, char* end)
+      {
+      setg(begin, begin, end);
+      }
+   //! Current read position
+   const char* position() const
+      {
+      return gptr();
+      }
+   //! Number of bytes left to read
+   std::streamsize available() const
+      {
+      return egptr() - gptr();
+      }
+   //! Skip over the given number of bytes
+   void skip(int n)
+      {
+      gbump(n);
+      }
+};
+
+//! Number of rows to convert in one block, for a given row size in bytes
+int block_rows(const int rowbytes, const int rows)
    {
-   libbase::trace << "Saving image" << std::flush;
-   // header data
-   const int chan = channels();
-   assert(chan > 0);
-   const int rows = m_data(0).size().rows();
-   const int cols = m_data(0).size().cols();
-   libbase::trace << " (" << cols << "×" << rows << "×" << chan << ")..."
-         << std::flush;
-   // write file descriptor
-   if (chan == 1 && m_maxval == 1)
-      sout << "P4" << std::endl; // bitmap
-   else if (chan == 1 && m_maxval > 1)
-      sout << "P5" << std::endl; // graymap
-   else if (chan == 3)
-      sout << "P6" << std::endl; // pixmap
-   else
-      failwith("Image format not supported");
-   // write comment
-   sout << "# file written by libimage" << std::endl;
-   // write image size
-   sout << cols << " " << rows << std::endl;
-   // if needed, write maxval
-   if (chan > 1 || m_maxval > 1)
-      sout << m_maxval << std::endl;
-   // write image data
-   for (int i = 0; i < rows; i++)
-      for (int j = 0; j < cols; j++)
-         for (int c = 0; c < chan; c++)
-            {
-            int p;
-            if (typeid(T) == typeid(double) || typeid(T) == typeid(float))
-               p = int(round(m_data(c)(i, j) * m_maxval));
-            else
-               p = int(m_data(c)(i, j));
-            assert(p >= 0 && p <= m_maxval);
-            if (m_maxval > 255) // 16-bit binary files (MSB first)
-               {
-               sout.put(p >> 8);
-               p &= 0xff;
-               }
-            sout.put(p);
-            }
-   // done
-   libbase::trace << "done" << std::endl;
-   return sout;
+   const int blocksize = 1 << 18;
+   return std::max(1, std::min(rows, blocksize / std::max(1, rowbytes)));
    }
 
+} // end unnamed namespace
+
+// File format helpers
+
 template <class T>
-std::istream& image<T>::serialize(std::istream& sin)
+int image<T>::read_header(std::istream& sin)
    {
-   libbase::trace << "Loading image" << std::flush;
-   // header data
-   int cols, rows, chan;
-   bool binary;
    // read file header
    std::string line;
    std::getline(sin, line);
    // read file descriptor
    int descriptor;
-   assert(line[0] == 'P');
+   assertalways(line.size() > 1 && line[0] == 'P');
    std::istringstream(line.substr(1)) >> descriptor;
    assertalways(descriptor >= 1 && descriptor <= 6);
    // determine the number of channels
-   if (descriptor == 3 || descriptor == 6)
-      chan = 3;
-   else
-      chan = 1;
-   // determine the data format
-   if (descriptor >= 4 || descriptor <= 6)
-      binary = true;
-   else
-      binary = false;
+   const int chan = (descriptor == 3 || descriptor == 6) ? 3 : 1;
    // skip comments or empty lines
    do
       {
       std::getline(sin, line);
       } while (line.size() == 0 || line[0] == '#');
    // read image size
+   int cols, rows;
    std::istringstream(line) >> cols >> rows;
    // if necessary read pixel value range
    if (descriptor == 1 || descriptor == 4)
       {
       m_maxval = 1;
-      assertalways(!binary); // cannot handle binary bitmaps (packed bits)
+      // cannot handle binary bitmaps (packed bits)
+      assertalways(descriptor != 4);
       }
    else
       {
@@ -127,30 +152,229 @@ std::istream& image<T>::serialize(std::istream& sin)
    // set interal representation limits
    set_limits();
    // set up space to hold image
-   m_data.init(chan);
+   resize(rows, cols, chan);
+   return descriptor;
+   }
+
+/*!
+ * \brief Convert rows from interleaved binary samples
+ * \param buf Samples for 'n' rows, starting at row 'i'
+ *
+ * Samples are interleaved by channel, with 16-bit values stored MSB first.
+ */
+template <class T>
+void image<T>::decode_rows(const unsigned char* buf, int i, int n)
+   {
+   const int start = i * m_cols;
+   const int count = n * m_cols;
+   const int chan = m_chan;
+   const int maxval = m_maxval;
    for (int c = 0; c < chan; c++)
-      m_data(c).init(rows, cols);
-   // read image data
-   for (int i = 0; i < rows; i++)
-      for (int j = 0; j < cols; j++)
-         for (int c = 0; c < chan; c++)
+      {
+      T* p = plane(c) + start;
+      if (sample_bytes() == 1)
+         {
+         const unsigned char* b = buf + c;
+         for (int k = 0; k < count; k++, b += chan)
+            p[k] = pixel<T>::from_sample(*b, maxval);
+         }
+      else
+         {
+         const unsigned char* b = buf + 2 * c;
+         for (int k = 0; k < count; k++, b += 2 * chan)
+            p[k] = pixel<T>::from_sample((b[0] << 8) | b[1], maxval);
+         }
+#ifndef NDEBUG
+      for (int k = 0; k < count; k++)
+         assert(p[k] >= m_lo && p[k] <= m_hi);
+#endif
+      }
+   }
+
+/*!
+ * \brief Convert a row to interleaved binary samples
+ *
+ * The buffer must hold a complete row; the format is as for decode_rows().
+ */
+template <class T>
+void image<T>::encode_row(unsigned char* buf, int i) const
+   {
+   const int start = i * m_cols;
+   const int chan = m_chan;
+   const int maxval = m_maxval;
+   for (int c = 0; c < chan; c++)
+      {
+      const T* p = plane(c) + start;
+      if (sample_bytes() == 1)
+         {
+         unsigned char* b = buf + c;
+         for (int j = 0; j < m_cols; j++, b += chan)
+            {
+            const int s = pixel<T>::to_sample(p[j], maxval);
+            assert(s >= 0 && s <= maxval);
+            *b = (unsigned char) s;
+            }
+         }
+      else
+         {
+         unsigned char* b = buf + 2 * c;
+         for (int j = 0; j < m_cols; j++, b += 2 * chan)
+            {
+            const int s = pixel<T>::to_sample(p[j], maxval);
+            assert(s >= 0 && s <= maxval);
+            b[0] = (unsigned char) (s >> 8);
+            b[1] = (unsigned char) (s & 0xff);
+            }
+         }
+      }
+   }
+
+/*!
+ * \brief Read pixel values following the file header
+ *
+ * Binary samples are read and converted a block of rows at a time.
+ */
+template <class T>
+void image<T>::read_data(std::istream& sin, int descriptor)
+   {
+   if (descriptor >= 4)
+      {
+      // binary data, a block of rows at a time
+      const int rowbytes = m_cols * m_chan * sample_bytes();
+      const int n = block_rows(rowbytes, m_rows);
+      std::vector<unsigned char> buf(size_t(n) * rowbytes);
+      for (int i = 0; i < m_rows; i += n)
+         {
+         const int k = std::min(n, m_rows - i);
+         sin.read(reinterpret_cast<char*> (&buf[0]), std::streamsize(k)
+               * rowbytes);
+         assertalways(sin);
+         decode_rows(&buf[0], i, k);
+         }
+      }
+   else
+      {
+      // plain text data, interleaved by channel
+      const int count = m_rows * m_cols;
+      for (int k = 0; k < count; k++)
+         for (int c = 0; c < m_chan; c++)
             {
-            if (binary)
-               {
-               int p = sin.get();
-               if (m_maxval > 255) // 16-bit binary files (MSB first)
-                  p = (p << 8) + sin.get();
-               m_data(c)(i, j) = T(p);
-               }
-            else
-               sin >> m_data(c)(i, j);
-            assert(m_data(c)(i, j) >= 0 && m_data(c)(i, j) <= m_maxval);
+            int p;
+            sin >> p;
+            assert(p >= 0 && p <= m_maxval);
+            plane(c)[k] = pixel<T>::from_sample(p, m_maxval);
             }
+      }
+   }
+
+// File access
+
+/*!
+ * \brief Load image from named file
+ *
+ * On POSIX systems the file is memory-mapped, and binary samples are
+ * converted directly from the mapped data; elsewhere this reads the file
+ * through a stream.
+ */
+template <class T>
+void image<T>::load(const std::string& fname)
+   {
+#ifdef _WIN32
+   std::ifstream file(fname.c_str(), std::ios_base::in | std::ios_base::binary);
+   assertalways(file.is_open());
+   serialize(file);
+   libbase::verifycomplete(file);
+#else
+   const int fd = open(fname.c_str(), O_RDONLY);
+   assertalways(fd >= 0);
+   struct stat st;
+   assertalways(fstat(fd, &st) == 0 && st.st_size > 0);
+   const size_t length = size_t(st.st_size);
+   void* map = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   assertalways(map != MAP_FAILED);
+   char* data = static_cast<char*> (map);
+   memory_buffer buf(data, data + length);
+   std::istream sin(&buf);
+   libbase::trace << "Loading image" << std::flush;
+   const int descriptor = read_header(sin);
+   if (descriptor >= 4)
+      {
+      // convert directly from the mapped file
+      const std::streamsize bytes = std::streamsize(m_rows) * m_cols * m_chan
+            * sample_bytes();
+      if (buf.available() < bytes)
+         {
+         munmap(map, length);
+         failwith("Image file is truncated");
+         }
+      decode_rows(reinterpret_cast<const unsigned char*> (buf.position()), 0,
+            m_rows);
+      buf.skip(int(bytes));
+      }
+   else
+      read_data(sin, descriptor);
+   libbase::verifycomplete(sin);
+   munmap(map, length);
+   libbase::trace << "done" << std::endl;
+#endif
+   }
+
+// Saving/loading functions
+
+template <class T>
+std::ostream& image<T>::serialize(std::ostream& sout) const
+   {
+   libbase::trace << "Saving image" << std::flush;
+   // header data
+   const int chan = channels();
+   assert(chan > 0);
+   const int rows = m_rows;
+   const int cols = m_cols;
+   libbase::trace << " (" << cols << "×" << rows << "×" << chan << ")..."
+         << std::flush;
+   // write file descriptor
+   if (chan == 1 && m_maxval == 1)
+      sout << "P4" << std::endl; // bitmap
+   else if (chan == 1 && m_maxval > 1)
+      sout << "P5" << std::endl; // graymap
+   else if (chan == 3)
+      sout << "P6" << std::endl; // pixmap
+   else
+      failwith("Image format not supported");
+   // write comment
+   sout << "# file written by libimage" << std::endl;
+   // write image size
+   sout << cols << " " << rows << std::endl;
+   // if needed, write maxval
+   if (chan > 1 || m_maxval > 1)
+      sout << m_maxval << std::endl;
+   // write image data, a block of rows at a time
+   const int rowbytes = cols * chan * sample_bytes();
+   const int n = block_rows(rowbytes, rows);
+   std::vector<unsigned char> buf(size_t(n) * rowbytes);
+   for (int i = 0; i < rows; i += n)
+      {
+      const int k = std::min(n, rows - i);
+      for (int r = 0; r < k; r++)
+         encode_row(&buf[size_t(r) * rowbytes], i + r);
+      sout.write(reinterpret_cast<const char*> (&buf[0]), std::streamsize(k)
+            * rowbytes);
+      }
+   // done
+   libbase::trace << "done" << std::endl;
+   return sout;
+   }
+
+template <class T>
+std::istream& image<T>::serialize(std::istream& sin)
+   {
+   libbase::trace << "Loading image" << std::flush;
+   // read file header and set up space to hold image
+   const int descriptor = read_header(sin);
+   // read image data
+   read_data(sin, descriptor);
    assertalways(sin);
-   // scale down if we're using floating-point
-   if (is_scaled())
-      for (int c = 0; c < chan; c++)
-         m_data(c) /= T(m_maxval);
    // done
    libbase::trace << "done" << std::endl;
    return sin;
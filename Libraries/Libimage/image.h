@@ -27,7 +27,10 @@
 #include "vector.h"
 #include "serializer.h"
 
+#include <algorithm>
 #include <iostream>
+#include <string>
+#include <typeinfo>
 
 namespace libimage {
 
@@ -39,16 +42,25 @@ namespace libimage {
  * image, potentially containing a number of channels. According to common
  * convention in image processing, the origin is at the top left, so that
  * row-major order gives the normal raster conversion.
+ *
+ * Channels are held as contiguous planes, which may be accessed directly
+ * through plane(). Binary image files are read and written a block of rows
+ * at a time.
  */
 
 template <class T>
 class image : public libbase::serializable {
 private:
-   //! Internal image representation
-   libbase::vector<libbase::matrix<T> > m_data;
+   /*! \name Internal representation */
+   //! Pixel values, stored as contiguous planes in row-major order
+   libbase::vector<T> m_data;
+   int m_rows;
+   int m_cols;
+   int m_chan;
    T m_lo;
    T m_hi;
    int m_maxval;
+   // @}
 protected:
    //! Returns true if pixel values are scaled to [0.0,1.0]
    static bool is_scaled()
@@ -69,6 +81,21 @@ protected:
          m_hi = T(m_maxval);
          }
       }
+   /*! \name File format helpers */
+   //! Read file header, returning the descriptor, and set up image space
+   int read_header(std::istream& sin);
+   //! Number of bytes per sample in binary files
+   int sample_bytes() const
+      {
+      return (m_maxval > 255) ? 2 : 1;
+      }
+   //! Read pixel values following the file header
+   void read_data(std::istream& sin, int descriptor);
+   //! Convert rows from interleaved binary samples
+   void decode_rows(const unsigned char* buf, int i, int n);
+   //! Convert a row to interleaved binary samples
+   void encode_row(unsigned char* buf, int i) const;
+   // @}
 public:
    // Construction / destruction
    explicit image(int rows = 0, int cols = 0, int c = 0, int maxval = 255) :
@@ -83,9 +110,10 @@ public:
    // resizing
    void resize(int rows, int cols, int c)
       {
-      m_data.init(c);
-      for (int i = 0; i < c; i++)
-         m_data(i).init(rows, cols);
+      m_rows = rows;
+      m_cols = cols;
+      m_chan = c;
+      m_data.init(c * rows * cols);
       }
 
    /*! \name Information functions */
@@ -107,33 +135,66 @@ public:
    //! Number of channels (image planes)
    int channels() const
       {
-      return m_data.size();
+      return m_chan;
       }
    //! Image size in rows and columns
    libbase::size_type<libbase::matrix> size() const
       {
       if (channels() > 0)
-         return m_data(0).size();
+         return libbase::size_type<libbase::matrix>(m_rows, m_cols);
       return libbase::size_type<libbase::matrix>(0, 0);
       }
    // @}
 
    /*! \name Pixel access */
+   //! Contiguous pixel values for channel, in row-major order
+   T* plane(int c)
+      {
+      assert(c >= 0 && c < channels());
+      return &m_data(0) + c * m_rows * m_cols;
+      }
+   //! Contiguous pixel values for channel, in row-major order
+   const T* plane(int c) const
+      {
+      assert(c >= 0 && c < channels());
+      return &m_data(0) + c * m_rows * m_cols;
+      }
+   //! Pixel value at given channel, row and column
+   T& operator()(int c, int i, int j)
+      {
+      assert(i >= 0 && i < m_rows && j >= 0 && j < m_cols);
+      return plane(c)[i * m_cols + j];
+      }
+   //! Pixel value at given channel, row and column
+   const T& operator()(int c, int i, int j) const
+      {
+      assert(i >= 0 && i < m_rows && j >= 0 && j < m_cols);
+      return plane(c)[i * m_cols + j];
+      }
    //! Extract channel as a matrix of pixel values
    libbase::matrix<T> getchannel(int c) const
       {
-      assert(c >= 0 && c < channels());
-      return m_data(c);
+      libbase::matrix<T> m(m_rows, m_cols);
+      const T* p = plane(c);
+      for (int i = 0; i < m_rows; i++, p += m_cols)
+         std::copy(p, p + m_cols, &m(i, 0));
+      return m;
       }
    //! Copy matrix of pixel values to channel
    void setchannel(int c, const libbase::matrix<T>& m)
       {
-      assert(c >= 0 && c < channels());
       assert(m.size() == size());
-      m_data(c) = m;
+      T* p = plane(c);
+      for (int i = 0; i < m_rows; i++, p += m_cols)
+         std::copy(&m(i, 0), &m(i, 0) + m_cols, p);
       }
    // @}
 
+   /*! \name File access */
+   //! Load image from named file, memory-mapping it where possible
+   void load(const std::string& fname);
+   // @}
+
    // Serialization Support
 DECLARE_BASE_SERIALIZER(image)
 DECLARE_SERIALIZER(image)
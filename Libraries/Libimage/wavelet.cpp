@@ -21,6 +21,9 @@
 
 #include "wavelet.h"
 #include "itfunc.h"
+#include "randgen.h"
+#include <algorithm>
+#include <vector>
 
 namespace libimage {
 
@@ -58,17 +61,18 @@ vector<double> wavelet::quadrature(const vector<double>& g)
 
  */
 
-void wavelet::partial_transform(const vector<double>& in, vector<double>& out,
-      const int n) const
+void wavelet::partial_transform(double* x, double* b, const int n) const
    {
-   assert(in.size() == out.size());
-   assert(n <= in.size());
    // trap calls where n is too small
    if (n < 4)
       return;
-   // initialise workspace (since out & in may be the same vector)
-   vector<double> b(n);
-   b = 0;
+   if (lifting)
+      {
+      lifting_transform(x, b, n);
+      return;
+      }
+   // initialise workspace
+   std::fill(b, b + n, 0.0);
    // set up some constants that we need
    const int nh = n >> 1;
    const int mask = n - 1;
@@ -78,24 +82,25 @@ void wavelet::partial_transform(const vector<double>& in, vector<double>& out,
       for (int j = 0; j < ncof; j++)
          {
          const int k = ((i << 1) + j) & mask;
-         b(i) += g(j) * in(k);
-         b(i + nh) += h(j) * in(k);
+         b[i] += g(j) * x[k];
+         b[i + nh] += h(j) * x[k];
          }
    // copy the result back from workspace
-   out.copyfrom(b);
+   std::copy(b, b + n, x);
    }
 
-void wavelet::partial_inverse(const vector<double>& in, vector<double>& out,
-      const int n) const
+void wavelet::partial_inverse(double* x, double* b, const int n) const
    {
-   assert(in.size() == out.size());
-   assert(n <= in.size());
    // trap calls where n is too small
    if (n < 4)
       return;
-   // initialise workspace (since out & in may be the same vector)
-   vector<double> b(n);
-   b = 0;
+   if (lifting)
+      {
+      lifting_inverse(x, b, n);
+      return;
+      }
+   // initialise workspace
+   std::fill(b, b + n, 0.0);
    // set up some constants that we need
    const int nh = n >> 1;
    const int mask = n - 1;
@@ -105,10 +110,112 @@ void wavelet::partial_inverse(const vector<double>& in, vector<double>& out,
       for (int j = 0; j < ncof; j++)
          {
          const int k = ((i << 1) + j) & mask;
-         b(k) += g(j) * in(i) + h(j) * in(i + nh);
+         b[k] += g(j) * x[i] + h(j) * x[i + nh];
          }
    // copy the result back from workspace
-   out.copyfrom(b);
+   std::copy(b, b + n, x);
+   }
+
+namespace {
+
+/*!
+ * \brief Lifting step: a(i) += sign * sum_j q(j) b(i + offset + j)
+ *
+ * Indices into 'b' are taken modulo n, which must be a power of two; the
+ * wrap-around is only applied at the ends.
+ */
+inline void lift(double* a, const double* b, const int n, const int offset,
+      const vector<double>& q, const double sign)
+   {
+   const int len = q.size();
+   if (len == 0)
+      return;
+   const int mask = n - 1;
+   const double* qp = &q(0);
+   // range of outputs needing no wrap-around
+   const int start = std::min(n, std::max(0, -offset));
+   const int end = std::max(start, std::min(n, n - offset - len + 1));
+   for (int i = 0; i < n; i++)
+      {
+      if (i == start)
+         {
+         for (; i < end; i++)
+            {
+            const double* p = b + i + offset;
+            double s = 0;
+            for (int j = 0; j < len; j++)
+               s += qp[j] * p[j];
+            a[i] += sign * s;
+            }
+         if (i == n)
+            break;
+         }
+      double s = 0;
+      for (int j = 0; j < len; j++)
+         s += qp[j] * b[(i + offset + j) & mask];
+      a[i] += sign * s;
+      }
+   }
+
+} // end unnamed namespace
+
+void wavelet::lifting_transform(double* x, double* b, const int n) const
+   {
+   const int nh = n >> 1;
+   const int mask = nh - 1;
+   // split into even and odd halves
+   for (int i = 0; i < nh; i++)
+      {
+      b[i] = x[i << 1];
+      b[i + nh] = x[(i << 1) + 1];
+      }
+   double* e = b;
+   double* o = b + nh;
+   // apply the swap-and-update steps
+   for (int k = 0; k < steps.size(); k++)
+      {
+      std::swap(e, o);
+      lift(e, o, nh, steps(k).offset, steps(k).q, 1);
+      }
+   // scale and shift into the output
+   for (int i = 0; i < nh; i++)
+      {
+      x[i] = ke * e[(i + me) & mask];
+      x[i + nh] = ko * o[(i + mo) & mask];
+      }
+   // final step on the high-pass output
+   lift(x + nh, x, nh, last.offset, last.q, 1);
+   }
+
+void wavelet::lifting_inverse(double* x, double* b, const int n) const
+   {
+   const int nh = n >> 1;
+   const int mask = nh - 1;
+   // undo the final step
+   lift(x + nh, x, nh, last.offset, last.q, -1);
+   // locate the halves as they were after the forward steps
+   double* e = b;
+   double* o = b + nh;
+   if (steps.size() & 1)
+      std::swap(e, o);
+   // undo the scale and shift
+   for (int i = 0; i < nh; i++)
+      {
+      e[(i + me) & mask] = x[i] / ke;
+      o[(i + mo) & mask] = x[i + nh] / ko;
+      }
+   // undo the swap-and-update steps in reverse order
+   for (int k = steps.size() - 1; k >= 0; k--)
+      {
+      lift(e, o, nh, steps(k).offset, steps(k).q, -1);
+      std::swap(e, o);
+      }
+   // interleave even and odd halves
+   for (int i = 0; i < nh; i++)
+      {
+      x[i << 1] = b[i];
+      x[(i << 1) + 1] = b[i + nh];
+      }
    }
 /*
  void wavelet::partial_titransform(vector<double>& a, vector<double>& hsr, vector<double>& hsl, vector<double>& lsr, vector<double>& lsl) const
@@ -140,6 +247,251 @@ void wavelet::partial_inverse(const vector<double>& in, vector<double>& out,
  }
  }
  */
+// static helper functions - lifting factorization
+
+namespace {
+
+/*!
+ * \brief Laurent polynomial with real coefficients
+ *
+ * Holds coefficients of z^lo up to z^(lo+c.size()-1); the empty polynomial
+ * represents zero.
+ */
+struct laurent {
+   int lo;
+   std::vector<double> c;
+   laurent() :
+         lo(0)
+      {
+      }
+   int hi() const
+      {
+      return lo + int(c.size()) - 1;
+      }
+   bool empty() const
+      {
+      return c.empty();
+      }
+   //! Remove negligible coefficients at either end
+   void trim()
+      {
+      const double tol = 1e-10;
+      while (!c.empty() && fabs(c.back()) <= tol)
+         c.pop_back();
+      int k = 0;
+      while (k < int(c.size()) && fabs(c[k]) <= tol)
+         k++;
+      c.erase(c.begin(), c.begin() + k);
+      lo += k;
+      if (c.empty())
+         lo = 0;
+      }
+   //! Add a*z^p
+   void add(const double a, const int p)
+      {
+      if (c.empty())
+         {
+         lo = p;
+         c.push_back(a);
+         return;
+         }
+      if (p < lo)
+         {
+         c.insert(c.begin(), lo - p, 0.0);
+         lo = p;
+         }
+      if (p > hi())
+         c.resize(p - lo + 1, 0.0);
+      c[p - lo] += a;
+      }
+};
+
+laurent operator+(const laurent& a, const laurent& b)
+   {
+   laurent r = a;
+   for (size_t i = 0; i < b.c.size(); i++)
+      r.add(b.c[i], b.lo + int(i));
+   r.trim();
+   return r;
+   }
+
+laurent operator*(const laurent& a, const laurent& b)
+   {
+   laurent r;
+   for (size_t i = 0; i < a.c.size(); i++)
+      for (size_t j = 0; j < b.c.size(); j++)
+         r.add(a.c[i] * b.c[j], a.lo + b.lo + int(i + j));
+   r.trim();
+   return r;
+   }
+
+laurent operator*(const double x, const laurent& a)
+   {
+   laurent r = a;
+   for (size_t i = 0; i < r.c.size(); i++)
+      r.c[i] *= x;
+   r.trim();
+   return r;
+   }
+
+laurent monomial(const double a, const int p)
+   {
+   laurent r;
+   r.add(a, p);
+   return r;
+   }
+
+/*!
+ * \brief Division with remainder: a = q b + r, with r shorter than b
+ *
+ * Each term of the quotient cancels the highest or lowest remaining term
+ * of the remainder, whichever needs the smaller coefficient; this keeps
+ * the factorization well-conditioned.
+ */
+void divide(const laurent& a, const laurent& b, laurent& q, laurent& r)
+   {
+   q = laurent();
+   r = a;
+   while (!r.empty() && r.c.size() >= b.c.size())
+      {
+      const double xhi = r.c.back() / b.c.back();
+      const double xlo = r.c.front() / b.c.front();
+      if (fabs(xhi) <= fabs(xlo))
+         {
+         const int p = r.hi() - b.hi();
+         q.add(xhi, p);
+         for (size_t j = 0; j < b.c.size(); j++)
+            r.c[p + b.lo - r.lo + j] -= xhi * b.c[j];
+         r.c.pop_back();
+         }
+      else
+         {
+         const int p = r.lo - b.lo;
+         q.add(xlo, p);
+         for (size_t j = 0; j < b.c.size(); j++)
+            r.c[j] -= xlo * b.c[j];
+         r.c.erase(r.c.begin());
+         r.lo++;
+         }
+      r.trim();
+      }
+   q.trim();
+   }
+
+//! Polyphase component of filter f, starting at the given index
+laurent polyphase(const vector<double>& f, const int start)
+   {
+   laurent r;
+   for (int i = start; i < f.size(); i += 2)
+      r.add(f(i), i >> 1);
+   r.trim();
+   return r;
+   }
+
+} // end unnamed namespace
+
+/*!
+ * \brief Determine the lifting factorization of the filter pair
+ *
+ * The partial transform computes low and high-pass outputs s(i) and d(i)
+ * from the even and odd inputs xe(i) = x(2i) and xo(i) = x(2i+1), using the
+ * polyphase matrix P = [Ge Go; He Ho]. Here Ge(z) = sum_k g(2k) z^k, etc.,
+ * and z is an advance by one position (modulo the half-length).
+ *
+ * Applying the Euclidean algorithm to Ge and Go gives quotients q1..qn such
+ * that P = [1 0; t 1] [K z^m 0; 0 K' z^m'] M(qn) ... M(q1), where
+ * M(q) = [1 q; 0 1] [0 1; 1 0]. Each M(q) swaps the two halves and adds the
+ * filtered odd half to the even half; this is computed in place, and needs
+ * far fewer operations than the filter bank form for longer filters.
+ *
+ * The factorization is computed numerically, so the result is checked
+ * against the filter bank form; the lifting form is only used if the two
+ * agree to within rounding.
+ */
+void wavelet::factorize()
+   {
+   lifting = false;
+   steps.init(0);
+   // polyphase matrix and its determinant, which must be a monomial
+   const laurent ge = polyphase(g, 0);
+   const laurent go = polyphase(g, 1);
+   const laurent he = polyphase(h, 0);
+   const laurent ho = polyphase(h, 1);
+   const laurent det = ge * ho + (-1.0) * (go * he);
+   if (det.c.size() != 1)
+      return;
+   // Euclidean algorithm on the top row
+   std::vector<laurent> q;
+   laurent a = ge, b = go;
+   while (!b.empty())
+      {
+      laurent qi, r;
+      divide(a, b, qi, r);
+      q.push_back(qi);
+      a = b;
+      b = r;
+      }
+   if (a.c.size() != 1)
+      return;
+   const int n = int(q.size());
+   // scale factors and offsets; det(M(q)) = -1
+   ke = a.c[0];
+   me = a.lo;
+   ko = det.c[0] / ke * ((n & 1) ? -1 : 1);
+   mo = det.lo - me;
+   // compute Q = M(qn) ... M(q1) to determine the final step
+   laurent q11 = monomial(1, 0), q12, q21, q22 = monomial(1, 0);
+   for (int i = 0; i < n; i++)
+      {
+      // [1 q; 0 1] [0 1; 1 0] = [q 1; 1 0]
+      const laurent r11 = q[i] * q11 + q21;
+      const laurent r12 = q[i] * q12 + q22;
+      q21 = q11;
+      q22 = q12;
+      q11 = r11;
+      q12 = r12;
+      }
+   // t = (He P0_22 - Ho P0_21) / det(P0), where P0 = diag(K z^m, K' z^m') Q
+   const laurent p21 = monomial(ko, mo) * q21;
+   const laurent p22 = monomial(ko, mo) * q22;
+   const laurent t = monomial(1 / det.c[0], -det.lo) * (he * p22 + (-1.0)
+         * (ho * p21));
+   // store the steps
+   steps.init(n);
+   for (int i = 0; i < n; i++)
+      {
+      steps(i).offset = q[i].lo;
+      steps(i).q.init(int(q[i].c.size()));
+      for (int j = 0; j < steps(i).q.size(); j++)
+         steps(i).q(j) = q[i].c[j];
+      }
+   last.offset = t.lo;
+   last.q.init(int(t.c.size()));
+   for (int j = 0; j < last.q.size(); j++)
+      last.q(j) = t.c[j];
+   // check against the filter bank form
+   const int size = 64;
+   vector<double> x(size), y(size), z(size), w(size);
+   libbase::randgen r;
+   r.seed(0);
+   for (int i = 0; i < size; i++)
+      x(i) = r.fval_closed() - 0.5;
+   y = x;
+   z = x;
+   for (int k = size; k >= 4; k >>= 1)
+      partial_transform(&y(0), &w(0), k);
+   lifting = true;
+   transform(&z(0), &w(0), size, 0);
+   if ((y - z).max() > 1e-9 || (z - y).max() > 1e-9)
+      {
+      lifting = false;
+      return;
+      }
+   inverse(&z(0), &w(0), size, 0);
+   if ((x - z).max() > 1e-9 || (z - x).max() > 1e-9)
+      lifting = false;
+   }
+
 // initialization
 
 void wavelet::init(const int type, const int par)
@@ -489,11 +841,15 @@ void wavelet::init(const int type, const int par)
    // normalise g and create quadrature filter
    g /= sqrt(g.sumsq());
    h = quadrature(g);
+   // determine the lifting form, if possible
+   factorize();
    // debug information
    libbase::trace << "wavelet initialised - type (" << type << ") par (" << par
          << ")." << std::endl;
    libbase::trace << "g = " << g << std::endl;
    libbase::trace << "h = " << h << std::endl;
+   libbase::trace << "lifting = " << lifting << " (" << steps.size()
+         << " steps)" << std::endl;
    }
 
 // informative / helper functions
@@ -505,80 +861,138 @@ int wavelet::getlimit(const int size, const int level) const
    return std::max(2, size >> level);
    }
 
+// transform / inverse functions - contiguous data
+
+void wavelet::transform(double* x, double* b, const int n, const int level) const
+   {
+   // start at the largest heirarchy and work towards the smallest
+   const int limit = getlimit(n, level) << 1;
+   for (int k = n; k >= limit; k >>= 1)
+      partial_transform(x, b, k);
+   }
+
+void wavelet::inverse(double* x, double* b, const int n, const int level) const
+   {
+   // start at the smallest heirarchy and work towards the largest
+   const int limit = getlimit(n, level) << 1;
+   for (int k = limit; k <= n; k <<= 1)
+      partial_inverse(x, b, k);
+   }
+
 // transform / inverse functions - vector
 
 void wavelet::transform(const vector<double>& in, vector<double>& out,
       const int level) const
    {
    assert(libbase::weight(in.size()) == 1);
-   // resize the output vector if necessary
-   out.init(in.size());
-   // start at the largest heirarchy and work towards the smallest
-   const int limit = getlimit(in.size(), level) << 1;
-   for (int n = in.size(); n >= limit; n >>= 1)
-      partial_transform(in, out, n);
+   const int n = in.size();
+   // copy input to output and transform in place
+   if (&out != &in)
+      out = in;
+   vector<double> b(n);
+   transform(&out(0), &b(0), n, level);
    }
 
 void wavelet::inverse(const vector<double>& in, vector<double>& out,
       const int level) const
    {
    assert(libbase::weight(in.size()) == 1);
-   // resize the output vector if necessary
-   out.init(in.size());
-   // start at the smallest heirarchy and work towards the largest
-   const int limit = getlimit(in.size(), level) << 1;
-   for (int n = limit; n <= in.size(); n <<= 1)
-      partial_inverse(in, out, n);
+   const int n = in.size();
+   // copy input to output and transform in place
+   if (&out != &in)
+      out = in;
+   vector<double> b(n);
+   inverse(&out(0), &b(0), n, level);
    }
 
 // transform / inverse functions - matrix
 
-void wavelet::transform(const matrix<double>& in, matrix<double>& out,
-      const int level) const
+/*!
+ * \brief Transform matrix rows in place
+ *
+ * Each row is contiguous, so is transformed directly; rows are shared
+ * between threads, each with its own workspace.
+ */
+void wavelet::transform_rows(matrix<double>& m, const int level,
+      const bool forward) const
    {
-   assert(libbase::weight(in.size().rows()) == 1 && libbase::weight(in.size().cols()) == 1);
-   // resize the output matrix if necessary
-   out.init(in.size());
-   // loop variables
-   int i;
-   // do the transform for each dimension
-   vector<double> b;
-   for (i = 0; i < in.size().rows(); i++)
+   const int rows = m.size().rows();
+   const int cols = m.size().cols();
+#pragma omp parallel
+   {
+   vector<double> b(cols);
+#pragma omp for schedule(static)
+   for (int i = 0; i < rows; i++)
       {
-      in.extractrow(b, i);
-      transform(b, b, level);
-      out.insertrow(b, i);
+      if (forward)
+         transform(&m(i, 0), &b(0), cols, level);
+      else
+         inverse(&m(i, 0), &b(0), cols, level);
       }
-   for (i = 0; i < in.size().cols(); i++)
+   }
+   }
+
+/*!
+ * \brief Transform matrix columns in place
+ *
+ * Columns are gathered in blocks into contiguous buffers, so that the
+ * matrix is read and written a row segment at a time; blocks are shared
+ * between threads.
+ */
+void wavelet::transform_cols(matrix<double>& m, const int level,
+      const bool forward) const
+   {
+   const int rows = m.size().rows();
+   const int cols = m.size().cols();
+   const int block = std::min(cols, 16);
+#pragma omp parallel
+   {
+   vector<double> a(block * rows);
+   vector<double> b(rows);
+#pragma omp for schedule(static)
+   for (int c = 0; c < cols; c += block)
       {
-      out.extractcol(b, i);
-      transform(b, b, level);
-      out.insertcol(b, i);
+      const int w = std::min(block, cols - c);
+      // gather
+      for (int i = 0; i < rows; i++)
+         for (int j = 0; j < w; j++)
+            a(j * rows + i) = m(i, c + j);
+      // transform
+      for (int j = 0; j < w; j++)
+         {
+         if (forward)
+            transform(&a(j * rows), &b(0), rows, level);
+         else
+            inverse(&a(j * rows), &b(0), rows, level);
+         }
+      // scatter
+      for (int i = 0; i < rows; i++)
+         for (int j = 0; j < w; j++)
+            m(i, c + j) = a(j * rows + i);
       }
    }
+   }
+
+void wavelet::transform(const matrix<double>& in, matrix<double>& out,
+      const int level) const
+   {
+   assert(libbase::weight(in.size().rows()) == 1 && libbase::weight(in.size().cols()) == 1);
+   // copy input to output and transform in place, each dimension in turn
+   if (&out != &in)
+      out = in;
+   transform_rows(out, level, true);
+   transform_cols(out, level, true);
+   }
 
 void wavelet::inverse(const matrix<double>& in, matrix<double>& out,
       const int level) const
    {
    assert(libbase::weight(in.size().rows()) == 1 && libbase::weight(in.size().cols()) == 1);
-   // resize the output matrix if necessary
-   out.init(in.size());
-   // loop variables
-   int i;
-   // do the transform for each dimension
-   vector<double> b;
-   for (i = 0; i < in.size().rows(); i++)
-      {
-      in.extractrow(b, i);
-      inverse(b, b, level);
-      out.insertrow(b, i);
-      }
-   for (i = 0; i < in.size().cols(); i++)
-      {
-      out.extractcol(b, i);
-      inverse(b, b, level);
-      out.insertcol(b, i);
-      }
+   // copy input to output and transform in place, each dimension in turn
+   if (&out != &in)
+      out = in;
+   transform_rows(out, level, false);
+   transform_cols(out, level, false);
    }
 
 } // end namespace
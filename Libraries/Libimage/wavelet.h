@@ -66,6 +66,13 @@
  Version 1.40 (10 Nov 2006)
  * defined class and associated data within "libimage" namespace.
  * removed use of "using namespace std", replacing by tighter "using" statements as needed.
+
+ Version 1.50 (18 Oct 2026)
+ * transforms work in place on contiguous rows, with a blocked column pass; rows
+   and column blocks are processed in parallel.
+ * added lifting-scheme implementation, using a factorization of the polyphase
+   matrix computed on initialization; the filter-bank form is kept for filters
+   where this does not reproduce its results.
  */
 
 namespace libimage {
@@ -74,21 +81,43 @@ class wavelet {
 protected:
    // the quadrature mirror filters
    libbase::vector<double> g, h;
+   // lifting factorization of the polyphase matrix (if available)
+   struct lifting_step {
+      int offset; // index offset of first coefficient
+      libbase::vector<double> q; // filter coefficients
+   };
+   bool lifting; // flag indicating the lifting form is used
+   libbase::vector<lifting_step> steps; // swap and update steps, in order
+   double ke, ko; // scale factors for low and high-pass outputs
+   int me, mo; // index offsets for low and high-pass outputs
+   lifting_step last; // final step, on the low-pass output
 protected:
    // from the [smoothing] filter 'g' generate the quadrature [detail] filter 'h'
    static libbase::vector<double> quadrature(const libbase::vector<double>& g);
-   // partial forward and inverse transforms
-   void partial_transform(const libbase::vector<double>& in, libbase::vector<
-         double>& out, const int n) const;
-   void partial_inverse(const libbase::vector<double>& in, libbase::vector<
-         double>& out, const int n) const;
+   // lifting factorization
+   void factorize();
+   // partial forward and inverse transforms, in place on contiguous data
+   void partial_transform(double* x, double* b, const int n) const;
+   void partial_inverse(double* x, double* b, const int n) const;
+   void lifting_transform(double* x, double* b, const int n) const;
+   void lifting_inverse(double* x, double* b, const int n) const;
+   // complete transforms, in place on contiguous data
+   void transform(double* x, double* b, const int n, const int level) const;
+   void inverse(double* x, double* b, const int n, const int level) const;
+   // transforms along each matrix dimension, in place
+   void transform_rows(libbase::matrix<double>& m, const int level,
+         const bool forward) const;
+   void transform_cols(libbase::matrix<double>& m, const int level,
+         const bool forward) const;
    // partial translation-invariant transforms
    //void partial_titransform(vector<double>& a, vector<double>& hsr, vector<double>& hsl, vector<double>& lsr, vector<double>& lsl) const;
 public:
-   wavelet()
+   wavelet() :
+         lifting(false)
       {
       }
-   wavelet(const int type, const int par = 0)
+   wavelet(const int type, const int par = 0) :
+         lifting(false)
       {
       init(type, par);
       }
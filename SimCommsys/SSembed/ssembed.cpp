@@ -27,7 +27,6 @@
 
 #include <boost/program_options.hpp>
 #include <iostream>
-#include <fstream>
 #include <typeinfo>
 
 namespace ssembed {
@@ -36,11 +35,8 @@ template <class S>
 libimage::image<S> loadimage(const std::string& fname)
    {
    // load image from file
-   std::ifstream file(fname.c_str(), std::ios_base::in | std::ios_base::binary);
-   assertalways(file.is_open());
    libimage::image<S> im;
-   im.serialize(file);
-   libbase::verifycomplete(file);
+   im.load(fname);
    return im;
    }
 
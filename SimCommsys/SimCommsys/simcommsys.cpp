@@ -45,11 +45,40 @@ private:
    bool quiet; //!< Flag to disable intermediate displays
    bool hard_int; //!< Flag indicating a hard interrupt (stop completely)
    bool soft_int; //!< Flag indicating a soft interrupt (skip to next point)
+   bool use_floor_min; //!< Flag indicating floor_min is set
+   bool use_floor_max; //!< Flag indicating floor_max is set
+   double floor_min; //!< Stop when at least one result is below this
+   double floor_max; //!< Stop when all results are below this
 public:
    mymontecarlo(bool quiet) :
-         quiet(quiet), hard_int(false), soft_int(false)
+         quiet(quiet), hard_int(false), soft_int(false), use_floor_min(
+               false), use_floor_max(false), floor_min(0), floor_max(0)
       {
       }
+   //! Set threshold for stopping when at least one result is below it
+   void set_floor_min(double floor_min)
+      {
+      use_floor_min = true;
+      this->floor_min = floor_min;
+      }
+   //! Set threshold for stopping when all results are below it
+   void set_floor_max(double floor_max)
+      {
+      use_floor_max = true;
+      this->floor_max = floor_max;
+      }
+   /*! \brief Sweep cut-off check
+    * Returns true if the given result is below either of the floor values
+    * set by the user.
+    */
+   bool cutoff(const libbase::vector<double>& result) const
+      {
+      if (use_floor_min && result.min() < floor_min)
+         return true;
+      if (use_floor_max && result.max() < floor_max)
+         return true;
+      return false;
+      }
    /*! \brief Conditional progress display
     *
     * If the object was set up to be quiet, then no display occurs, otherwise
@@ -184,6 +213,10 @@ int main(int argc, char *argv[])
          "minimum number of samples");
    desc.add_options()("seed,s", po::value<libbase::int32u>(),
          "system initialization seed (random if not stated)");
+   desc.add_options()("workers,w", po::value<int>()->default_value(0),
+         "number of workers for simulating parameter values concurrently "
+               "(local mode only); 0 to simulate one value at a time. "
+               "Any interrupt stops the whole sweep.");
    po::variables_map vm;
    po::store(po::parse_command_line(argc, argv, desc), vm);
    po::notify(vm);
@@ -240,6 +273,26 @@ int main(int argc, char *argv[])
                estimator.set_min_samples(vm["min-samples"].as<int>());
             if (vm.count("seed"))
                estimator.set_seed(vm["seed"].as<libbase::int32u> ());
+            if (vm.count("floor-min"))
+               estimator.set_floor_min(vm["floor-min"].as<double>());
+            if (vm.count("floor-max"))
+               estimator.set_floor_max(vm["floor-max"].as<double>());
+
+            // Simulate all SNR values concurrently, if requested
+            if (vm["workers"].as<int>() > 0)
+               {
+               cerr << "Simulating system at " << pset.size()
+                     << " parameter values with " << vm["workers"].as<int>()
+                     << " workers" << std::endl;
+               libbase::vector<libbase::vector<double> > estimate,
+                     errormargin;
+               estimator.estimate(pset, vm["workers"].as<int>(), estimate,
+                     errormargin);
+               cerr << "Statistics: " << setprecision(4)
+                     << estimator.get_timer() << " for all parameter values"
+                     << std::endl;
+               break;
+               }
 
             // Work out the following for every SNR value required
             for (int i = 0; i < pset.size(); i++)
@@ -261,11 +314,7 @@ int main(int argc, char *argv[])
                // handle pre-mature breaks
                if (estimator.interrupt() && !estimator.interrupt_was_soft())
                   break;
-               if (vm.count("floor-min")
-                     && estimate.min() < vm["floor-min"].as<double>())
-                  break;
-               if (vm.count("floor-max")
-                     && estimate.max() < vm["floor-max"].as<double>())
+               if (estimator.cutoff(estimate))
                   break;
                }
             }